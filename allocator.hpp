@@ -1,11 +1,20 @@
 #ifndef LWE_UTILITIES_ALLOCATOR_HPP
 #define LWE_UTILITIES_ALLOCATOR_HPP
 
-#include <set>
-#include <stack>
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <span>
+#include <stdexcept>
+#include <type_traits>
+#include <vector>
 
 #include "config.h"
 #include "lock.hpp"
+#include "page.hpp"
+#include "telemetry.hpp"
+#include "trace.hpp"
 #include "type.h"
 
 /*
@@ -15,7 +24,9 @@
     - Construct   : ptr = new T
     - Deconstruct : delete ptr
     - Expand      : create block
-    - Reduce      : release block
+    - Reduce      : release or decommit block, coldest first
+    - Batch       : AllocateBatch / ConstructBatch / DeconstructBatch / DeallocateBatch, one lock
+    - Trim        : decay, see retention
 
     MemoryPool<64, 8, 8>
     ┌────┬────┬────┐
@@ -58,15 +69,100 @@
     │          │       ├ ─ ─ ┴───────> metadata address
     │          └ ─ ─ ─ ┴─────────────> chunk instance
     │
+    ├ ─ 8 byte: usable since (Trim clock)
     ├ ─ 8 byte: used object counter
+    ├ ─ 8 byte: carved object counter
     ├ ─ 8 byte: next object pointer
     ├ ─ 8 byte: next block pointer
     ├ ─ 8 byte: prev block pointer
     ├ ─ 8 byte: parent pool pointer
-    └─> total 40 + padding byte
+    ├ ─ 8 byte: tag, set by owner (size class)
+    └─> total 64 + padding byte
+
+    carving
+    - new segment is not touched except metadata, Expand() is O(1)
+    - returned chunks first (head), then never used chunks (carved)
+    - LockFree links every chunk on creation
+
+    batch
+    - AllocateBatch takes runs of one segment: returned chunks, then carved
+    - DeallocateBatch links adjacent chunks of the same segment as one run
+    - ThreadCache / LockFree: per chunk, no lock anyway
+
+    Packet* burst[64];
+    size_t  n = pool.AllocateBatch(64, burst);
+    pool.DeallocateBatch<Packet>({ burst, n });
+
+    ThreadCache<Mtx, SIZE>
+    - pass as Mtx: Allocator<T, ThreadCache<SpinLock, 32>>
+    - each thread keeps up to SIZE free chunks (magazine)
+    - empty magazine: refill SIZE / 2 chunks with one lock
+    - full magazine : flush SIZE / 2 chunks with one lock
+    - chunks in a magazine are counted as used in INFO
+    - one magazine per instance, MEMORY_CACHE_INSTANCE_DEFAULT instances per thread
+    - more instances on one thread: the least recent magazine is flushed for the new one
+
+    LockFree
+    - pass as Mtx: Allocator<T, LockFree> or Allocator<T, ThreadCache<LockFree>>
+    - free chunks are one stack of tagged pointers (48 bit address + 16 bit version)
+    - Allocate / Deallocate: CAS only, lock only when expanding
+    - segments are kept until destruction, Reduce() does nothing
+    - INFO.block counts total only
+
+    Layout
+    - Linked: each chunk keeps its segment pointer (default, as above)
+    - Masked: segment is aligned to its own power-of-two size
+              segment = address & ~(BLOCK_TOTAL_SIZE - 1), no pointer in chunk
+              CHUNK_COUNT grows to fill the segment (>= COUNT)
+
+    Allocator<Block<24>, SpinLock, 64, 8, Masked>
+    ┌──────────┬────┬────┬ ─ ─ ┬────┐
+    │ metadata │ 24 │ 24 │ ... │ 24 │ 2048 byte aligned
+    └──────────┴────┴────┴ ─ ─ ┴────┘
+    = 64 + 24 * 82 byte
+    INFO.chunk.footprint: 25 byte (Linked: 33 byte)
+
+    Telemetry
+    - every instance is listed in Telemetry::Snapshot(), see telemetry.hpp
+
+    Provider
+    - where segments come from, see page.hpp
+    - Allocator<T, SpinLock, 64, 8, Linked, HugeProvider<true>>
+
+    retention
+    - Retain(blocks, bytes): fully usable segments kept as is, default 0
+    - Reduce(n): up to n surplus segments, coldest first
+                 Provider::DECOMMIT ? decommit, address kept (idle) : release
+    - Decay(ticks) + Trim(now): only segments usable for ticks are reduced,
+                                idle segments for ticks are released
+    - idle segment is committed again and carved from the start on reuse
+    - INFO.block.reserved: address range, INFO.block.committed: backed by memory
+
+    pool.Retain(4);
+    pool.Decay(1000);
+    pool.Trim(now_ms); // every tick
+
+    reserve
+    - Reserve(chunks, touch): idle segments committed, then new ones until chunks are usable
+    - touch: every page of those segments faulted in now, not on the first Allocate
+    - reserved segments are retained, Reduce / Trim do not give them back
+    - the reserve is a floor of its own, kept for the lifetime: Retain() sets only its own count,
+      max(Retain, largest Reserve) segments are kept
+
+    pool.Reserve(1 << 20); // at startup
+
+    Steal
+    - moves fully usable segments of other allocator of the same type
+    - no copy, segment keeps its chunks and address, only the owner changes
+    - not for LockFree, returns 0
 */
 
-template<typename, class, size_t, size_t> class Allocator;
+struct Linked {};
+struct Masked {};
+
+template<typename, class, size_t, size_t, class, class> class Allocator;
+
+template<class Mtx = SpinLock, size_t SIZE = EConfig::MEMORY_CACHE_DEFAULT> struct ThreadCache {};
 
 /*
     base
@@ -75,14 +171,30 @@ class Memory {
 public:
     struct Segment {
         void*    pool;
-        void*    head;
+        void*    head;   // returned chunks
+        uint64_t stamp;  // usable since
         size_t   used;
+        size_t   carved; // chunks handed out at least once
         Segment* next;
         Segment* prev;
+        size_t   tag; // set by owner, see Allocator::Tag
     };
 
 public:
-    template<typename T> struct Chunk {
+    /*
+        intrusive segment list by Segment::next / prev
+        push front, front is the latest
+    */
+    struct List {
+        void Push(Segment*);
+        void Erase(Segment*);
+
+        Segment* head = nullptr;
+        Segment* tail = nullptr;
+    };
+
+public:
+    template<typename T, class Layout = Linked> struct Chunk {
         static constexpr size_t SIZE = Aligner<sizeof(T)>::ALIGN_TO_POINTER;
         union {
             Block<SIZE> data;
@@ -91,6 +203,27 @@ public:
         Segment* block;
     };
 
+    template<typename T> struct Chunk<T, Masked> {
+        static constexpr size_t SIZE = Aligner<sizeof(T)>::ALIGN_TO_POINTER;
+        union {
+            Block<SIZE> data;
+            void*       next;
+        };
+    };
+
+public:
+    /*
+        pointer with version for CAS
+    */
+    struct Tagged {
+        static_assert(sizeof(void*) == 8, "Tagged requires 64 bit pointer.");
+
+        static constexpr uintptr_t MASK = (uintptr_t(1) << 48) - 1;
+
+        static void*     Pointer(uintptr_t);
+        static uintptr_t Next(uintptr_t, void*); // new pointer, version + 1
+    };
+
 public:
     struct Usage {
         struct {
@@ -98,6 +231,7 @@ public:
             size_t used;
             size_t total;
             size_t byte;
+            size_t footprint; // segment byte per chunk
         } chunk;
 
         struct {
@@ -106,7 +240,12 @@ public:
             size_t empty;
             size_t total;
             size_t byte;
+            size_t idle;      // decommitted
+            size_t committed; // byte
+            size_t reserved;  // byte
         } block;
+
+        Usage& operator+=(const Usage&); // sum of pools, footprint kept
     };
 
 public:
@@ -118,16 +257,37 @@ public:
         static constexpr size_t CHUNK_COUNT = COUNT;
         static constexpr size_t CHUNK_SIZE  = Chunk<T>::SIZE;
         static constexpr size_t ALIGNMENT   = Aligner<ALIGN>::POWER_OF_TWO;
+        static constexpr size_t CACHE_SIZE  = 0;
+        static constexpr bool   LOCK_FREE   = false;
+    };
+
+    template<typename T, size_t COUNT, size_t ALIGN>
+    struct Setting<T, LockFree, COUNT, ALIGN>: Setting<T, SpinLock, COUNT, ALIGN> {
+        static constexpr bool LOCK_FREE = true;
+    };
+
+    template<typename T, class Mtx, size_t SIZE, size_t COUNT, size_t ALIGN>
+    struct Setting<T, ThreadCache<Mtx, SIZE>, COUNT, ALIGN>: Setting<T, Mtx, COUNT, ALIGN> {
+        static constexpr size_t CACHE_SIZE = SIZE;
     };
 
 protected:
     Memory();
 
 protected:
-    Segment*             top = nullptr;
-    std::stack<Segment*> freeable;
-    std::set<Segment*>   all;
-    Usage                usage = { 0 };
+    List  full;    // all chunks usable, head is the latest released
+    List  partial; // some chunks usable, head is top
+    List  empty;   // no chunk usable
+    List  idle;    // all chunks usable, decommitted
+    Usage usage = { 0 };
+
+protected:
+    struct {
+        size_t   block    = 0; // kept full segment count, Retain
+        size_t   reserved = 0; // kept full segment count, largest Reserve
+        uint64_t decay    = 0;
+        uint64_t clock    = 0; // last Trim
+    } retention;
 
 public:
     const Usage& INFO;
@@ -135,44 +295,120 @@ public:
 
 template<typename T, class Mtx = void,
     size_t COUNT = EConfig::MEMORY_ALLOCATE_DEFAULT,
-    size_t ALIGN = EConfig::MEMORY_ALIGNMENT_DEFAULT>
+    size_t ALIGN = EConfig::MEMORY_ALIGNMENT_DEFAULT,
+    class Layout = Linked, class Provider = HeapProvider>
 class Allocator: public Memory {
     using Setter = Setting<T, Mtx, COUNT, ALIGN>;
 
 public:
-    using Chunk          = Chunk<T>;
+    using Chunk          = Chunk<T, Layout>;
     using AlignedSegment = Aligner<Setter::ALIGNMENT, Memory::Segment>::Type;
-    using AlignedChunk   = Aligner<Setter::ALIGNMENT, Memory::Chunk<T>>::Type;
+    using AlignedChunk   = Aligner<Setter::ALIGNMENT, Memory::Chunk<T, Layout>>::Type;
     using LockType       = Setter::LockType;
 
+private:
+    static constexpr bool   MASKED = std::is_same_v<Layout, Masked>;
+    static constexpr size_t SPAN   = Aligner<sizeof(AlignedSegment) + sizeof(AlignedChunk) * COUNT>::POWER_OF_TWO;
+
 public:
-    static constexpr size_t CHUNK_SIZE       = Setter::CHUNK_SIZE;
-    static constexpr size_t CHUNK_COUNT      = Setter::CHUNK_COUNT;
-    static constexpr size_t ALIGNMENT        = Setter::ALIGNMENT;
-    static constexpr size_t BLOCK_TOTAL_SIZE = sizeof(AlignedSegment) + sizeof(AlignedChunk) * CHUNK_COUNT;
+    static constexpr size_t CHUNK_SIZE  = Setter::CHUNK_SIZE;
+    static constexpr size_t CHUNK_COUNT = MASKED ? (SPAN - sizeof(AlignedSegment)) / sizeof(AlignedChunk) : COUNT;
+    static constexpr size_t ALIGNMENT   = Setter::ALIGNMENT;
+    static constexpr size_t CACHE_SIZE  = Setter::CACHE_SIZE;
+    static constexpr bool   LOCK_FREE   = Setter::LOCK_FREE;
+
+public:
+    static constexpr size_t BLOCK_TOTAL_SIZE =
+        MASKED ? SPAN : sizeof(AlignedSegment) + sizeof(AlignedChunk) * CHUNK_COUNT;
+    static constexpr size_t BLOCK_ALIGNMENT = MASKED ? SPAN : ALIGNMENT;
+
+private:
+    struct Magazine {
+        std::atomic<Allocator*> owner = nullptr;
+        size_t                  count = 0;
+        void*                   chunk[CACHE_SIZE ? CACHE_SIZE : 1];
+    };
+
+    struct Local {
+        static constexpr size_t SIZE = EConfig::MEMORY_CACHE_INSTANCE_DEFAULT;
+
+        ~Local();
+        std::shared_ptr<Magazine> magazine[SIZE]; // per instance, most recent first
+    };
 
 public:
     Allocator();
     ~Allocator();
 
 private:
-    void* GetChunck();
-    void  ReleaseChunk(void*);
-    bool  NewBlock();
-    void  FreeBlock();
+    void*    GetChunck();
+    void     ReleaseChunk(void*);
+    Segment* Top();                               // segment to allocate from
+    size_t   GetChunks(void**, size_t);           // runs of top segments
+    void     ReleaseChunks(void* const*, size_t); // runs of same segment
+    bool     NewBlock();
+    size_t   FreeBlock(size_t, uint64_t);         // from tail, usable before uint64_t
+    void     Release(List&, Segment*);
+    void     Decommit(Segment*);
+    void     Commit(Segment*);
+    void     Range(Segment*, uint8_t*&, size_t&); // decommit range
+    Segment* Donate();                            // detach coldest full segment
+    void     Adopt(Segment*);
+
+public:
+    static Segment* Owner(void*); // segment of chunk
+
+private:
+    Magazine* Bind();       // get magazine of this thread
+    void*     Pop();        // cached GetChunck
+    void      Push(void*);  // cached ReleaseChunk
+    void      Detach(Magazine*);
+    bool      Abandon();    // clear owner of magazines, false: one is detaching
+
+private:
+    void* PopFree();       // lock-free GetChunck
+    void  PushFree(void*); // lock-free ReleaseChunk
 
 public:
     template<typename U = T> U*                   Allocate();
     template<typename U = T, typename... Args> U* Construct(Args&&...);
     template<typename U = T> void                 Deconstruct(U* ptr);
     template<typename U = void> void              Deallocate(U*);
+    template<typename U = T> U*                   TryAllocate(); // nullptr instead of Expand
+
+public:
+    // one lock per call, span may contain nullptr
+    template<typename U = T> size_t                   AllocateBatch(size_t, U**); // allocated count
+    template<typename U = T, typename... Args> size_t ConstructBatch(size_t, U**, const Args&...);
+    template<typename U = T> void                     DeconstructBatch(std::type_identity_t<std::span<U* const>>);
+    template<typename U = T> void                     DeallocateBatch(std::type_identity_t<std::span<U* const>>);
 
 public:
     size_t Expand(size_t = 1);
-    size_t Reduce();
+    size_t Reserve(size_t chunks, bool touch = true); // usable >= chunks in one lock, segments created
+    size_t Reduce(size_t = SIZE_MAX);     // N surplus fully usable segments
+    size_t Trim(uint64_t now);            // decay by clock
+    size_t Steal(Allocator&, size_t = 1); // N fully usable segments of other
+
+public:
+    void Retain(size_t blocks, size_t bytes = 0); // keep max(blocks, bytes) segments
+    void Decay(uint64_t ticks);
+
+public:
+    const LockType& Locker() const; // INFO of lock, see lock.hpp stats
+    void            Tag(size_t);    // Segment::tag of segments created or adopted from now
+
+private:
+    LockType               mtx;
+    std::atomic<uintptr_t> list = 0; // lock-free chunk stack
+    size_t                 tag  = 0;
+
+private:
+    std::vector<std::shared_ptr<Magazine>> magazines;
+    static thread_local Local              local;
 
 private:
-    LockType mtx;
+    Telemetry::Entry telemetry;
 };
 
 #include "allocator.ipp"
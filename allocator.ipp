@@ -2,44 +2,180 @@
 
 #ifdef LWE_UTILITIES_ALLOCATOR_HPP
 
-template<typename T, class Mtx, size_t COUNT, size_t ALIGN>
+template<typename T, class Mtx, size_t COUNT, size_t ALIGN, class Layout, class Provider>
+thread_local Allocator<T, Mtx, COUNT, ALIGN, Layout, Provider>::Local Allocator<T, Mtx, COUNT, ALIGN, Layout, Provider>::local;
+
+template<typename T, class Mtx, size_t COUNT, size_t ALIGN, class Layout, class Provider>
 template<typename U>
-U* Allocator<T, Mtx, COUNT, ALIGN>::Allocate() {
-    [[maybe_unused]] LockGuard _(mtx);
-    return reinterpret_cast<U*>(GetChunck());
+U* Allocator<T, Mtx, COUNT, ALIGN, Layout, Provider>::Allocate() {
+    void* ptr;
+
+    if constexpr(CACHE_SIZE) {
+        ptr = Pop();
+    }
+
+    else if constexpr(LOCK_FREE) {
+        ptr = PopFree();
+    }
+
+    else {
+        [[maybe_unused]] LockGuard _(mtx);
+        ptr = GetChunck();
+    }
+
+    Trace::Write(Trace::ALLOCATE, uintptr_t(ptr), CHUNK_SIZE);
+    return reinterpret_cast<U*>(ptr);
 }
 
-template<typename T, class Mtx, size_t COUNT, size_t ALIGN>
+template<typename T, class Mtx, size_t COUNT, size_t ALIGN, class Layout, class Provider>
 template<typename U>
-void Allocator<T, Mtx, COUNT, ALIGN>::Deallocate(U* ptr) {
+void Allocator<T, Mtx, COUNT, ALIGN, Layout, Provider>::Deallocate(U* ptr) {
     if (ptr == nullptr) return;
 
+    // before release, reuse of the chunk is recorded later
+    Trace::Write(Trace::DEALLOCATE, uintptr_t(ptr), CHUNK_SIZE);
+
+    if constexpr(CACHE_SIZE) {
+        Push(reinterpret_cast<void*>(ptr));
+        return;
+    }
+
+    if constexpr(LOCK_FREE) {
+        PushFree(reinterpret_cast<void*>(ptr));
+        return;
+    }
+
     [[maybe_unused]] LockGuard _(mtx);
     ReleaseChunk(reinterpret_cast<void*>(ptr));
 }
 
-template<typename T, class Mtx, size_t COUNT, size_t ALIGN>
+template<typename T, class Mtx, size_t COUNT, size_t ALIGN, class Layout, class Provider>
 template<typename U, typename... Args>
-U* Allocator<T, Mtx, COUNT, ALIGN>::Construct(Args&&... args) {
+U* Allocator<T, Mtx, COUNT, ALIGN, Layout, Provider>::Construct(Args&&... args) {
+    if constexpr(CACHE_SIZE || LOCK_FREE) {
+        T* ptr = static_cast<T*>(CACHE_SIZE ? Pop() : PopFree());
+        Trace::Write(Trace::ALLOCATE, uintptr_t(ptr), CHUNK_SIZE);
+        if(ptr) new(ptr) T(std::forward<Args>(args)...);
+        return reinterpret_cast<U*>(ptr);
+    }
+
     [[maybe_unused]] LockGuard _(mtx);
 
     T* ptr = static_cast<T*>(GetChunck());
+    Trace::Write(Trace::ALLOCATE, uintptr_t(ptr), CHUNK_SIZE);
     new(ptr) T(std::forward<Args>(args)...);
     return reinterpret_cast<U*>(ptr);
 }
 
-template<typename T, class Mtx, size_t COUNT, size_t ALIGN>
+template<typename T, class Mtx, size_t COUNT, size_t ALIGN, class Layout, class Provider>
 template<typename U>
-void Allocator<T, Mtx, COUNT, ALIGN>::Deconstruct(U* ptr) {
+void Allocator<T, Mtx, COUNT, ALIGN, Layout, Provider>::Deconstruct(U* ptr) {
     if (ptr == nullptr) return;
 
+    Trace::Write(Trace::DEALLOCATE, uintptr_t(ptr), CHUNK_SIZE);
+
+    if constexpr(CACHE_SIZE || LOCK_FREE) {
+        reinterpret_cast<T*>(ptr)->~T();
+        if constexpr(CACHE_SIZE) Push(reinterpret_cast<void*>(ptr));
+        else PushFree(reinterpret_cast<void*>(ptr));
+        return;
+    }
+
     [[maybe_unused]] LockGuard _(mtx);
     reinterpret_cast<T*>(ptr)->~T();
     ReleaseChunk(ptr);
 }
 
-template<typename T, class Mtx, size_t COUNT, size_t ALIGN>
-size_t Allocator<T, Mtx, COUNT, ALIGN>::Expand(size_t count) {
+template<typename T, class Mtx, size_t COUNT, size_t ALIGN, class Layout, class Provider>
+template<typename U>
+size_t Allocator<T, Mtx, COUNT, ALIGN, Layout, Provider>::AllocateBatch(size_t count, U** out) {
+    size_t got = 0;
+
+    if constexpr(CACHE_SIZE || LOCK_FREE) {
+        while(got < count) {
+            void* chunk = CACHE_SIZE ? Pop() : PopFree();
+            if(!chunk) {
+                break;
+            }
+            out[got++] = static_cast<U*>(chunk);
+        }
+    }
+
+    else {
+        [[maybe_unused]] LockGuard _(mtx);
+        got = GetChunks(reinterpret_cast<void**>(out), count);
+    }
+
+    for(size_t i = 0; i < got; ++i) {
+        Trace::Write(Trace::ALLOCATE, uintptr_t(out[i]), CHUNK_SIZE);
+    }
+    return got;
+}
+
+template<typename T, class Mtx, size_t COUNT, size_t ALIGN, class Layout, class Provider>
+template<typename U, typename... Args>
+size_t Allocator<T, Mtx, COUNT, ALIGN, Layout, Provider>::ConstructBatch(size_t count, U** out, const Args&... args) {
+    size_t got = AllocateBatch(count, out);
+    for(size_t i = 0; i < got; ++i) {
+        new(out[i]) T(args...);
+    }
+    return got;
+}
+
+template<typename T, class Mtx, size_t COUNT, size_t ALIGN, class Layout, class Provider>
+template<typename U>
+void Allocator<T, Mtx, COUNT, ALIGN, Layout, Provider>::DeconstructBatch(std::type_identity_t<std::span<U* const>> ptrs) {
+    for(U* ptr : ptrs) {
+        if(ptr) reinterpret_cast<T*>(ptr)->~T();
+    }
+    DeallocateBatch<U>(ptrs);
+}
+
+template<typename T, class Mtx, size_t COUNT, size_t ALIGN, class Layout, class Provider>
+template<typename U>
+void Allocator<T, Mtx, COUNT, ALIGN, Layout, Provider>::DeallocateBatch(std::type_identity_t<std::span<U* const>> ptrs) {
+    for(U* ptr : ptrs) {
+        Trace::Write(Trace::DEALLOCATE, uintptr_t(ptr), CHUNK_SIZE);
+    }
+
+    if constexpr(CACHE_SIZE || LOCK_FREE) {
+        for(U* ptr : ptrs) {
+            if(ptr == nullptr) continue;
+            if constexpr(CACHE_SIZE) Push(reinterpret_cast<void*>(ptr));
+            else PushFree(reinterpret_cast<void*>(ptr));
+        }
+        return;
+    }
+
+    [[maybe_unused]] LockGuard _(mtx);
+
+    // runs between nulls
+    size_t begin = 0;
+    for(size_t i = 0; i <= ptrs.size(); ++i) {
+        if(i == ptrs.size() || ptrs[i] == nullptr) {
+            ReleaseChunks(reinterpret_cast<void* const*>(ptrs.data() + begin), i - begin);
+            begin = i + 1;
+        }
+    }
+}
+
+template<typename T, class Mtx, size_t COUNT, size_t ALIGN, class Layout, class Provider>
+template<typename U>
+U* Allocator<T, Mtx, COUNT, ALIGN, Layout, Provider>::TryAllocate() {
+    static_assert(!CACHE_SIZE && !LOCK_FREE, "TryAllocate requires a locked allocator.");
+
+    [[maybe_unused]] LockGuard _(mtx);
+    if(!partial.head && !full.head && !idle.head) {
+        return nullptr;
+    }
+
+    void* ptr = GetChunck();
+    Trace::Write(Trace::ALLOCATE, uintptr_t(ptr), CHUNK_SIZE);
+    return reinterpret_cast<U*>(ptr);
+}
+
+template<typename T, class Mtx, size_t COUNT, size_t ALIGN, class Layout, class Provider>
+size_t Allocator<T, Mtx, COUNT, ALIGN, Layout, Provider>::Expand(size_t count) {
     size_t created = 0;
 
     while(created < count) {
@@ -52,185 +188,782 @@ size_t Allocator<T, Mtx, COUNT, ALIGN>::Expand(size_t count) {
     return created;
 }
 
-template<typename T, class Mtx, size_t COUNT, size_t ALIGN>
-size_t Allocator<T, Mtx, COUNT, ALIGN>::Reduce() {
+template<typename T, class Mtx, size_t COUNT, size_t ALIGN, class Layout, class Provider>
+size_t Allocator<T, Mtx, COUNT, ALIGN, Layout, Provider>::Reserve(size_t chunks, bool touch) {
     [[maybe_unused]] LockGuard _(mtx);
 
-    size_t before = freeable.size();
-    FreeBlock();
-    return before - freeable.size();
-}
+    size_t blocks  = (chunks + CHUNK_COUNT - 1) / CHUNK_COUNT;
+    size_t created = 0;
 
-template<typename T, class Mtx, size_t COUNT, size_t ALIGN>
-void* Allocator<T, Mtx, COUNT, ALIGN>::GetChunck() {
-    if(top == nullptr) {
-        if(freeable.empty()) {
-            if(NewBlock() == false) {
-                return nullptr;
+    if(retention.reserved < blocks) {
+        retention.reserved = blocks;
+    }
+
+    if constexpr(!LOCK_FREE) {
+        // decommitted segments count as usable, back them first, only as many as needed
+        while(idle.head && usage.chunk.usable - usage.block.idle * CHUNK_COUNT < chunks) {
+            Segment* block = idle.head;
+            Commit(block);
+            full.Push(block);
+            ++usage.block.full;
+
+            if(touch) {
+                Page::Touch(reinterpret_cast<AlignedSegment*>(block) + 1, BLOCK_TOTAL_SIZE - sizeof(AlignedSegment));
             }
         }
+    }
 
-        else {
-            top = freeable.top();
-            freeable.pop();
+    while(std::atomic_ref<size_t>(usage.chunk.usable).load(std::memory_order_relaxed) < chunks) {
+        if(NewBlock() == false) {
+            telemetry.Fail();
+            break;
+        }
+        ++created;
+
+        // chunks are carved lazily, LockFree linked them already
+        if constexpr(!LOCK_FREE) {
+            if(touch) {
+                Page::Touch(reinterpret_cast<AlignedSegment*>(full.head) + 1, BLOCK_TOTAL_SIZE - sizeof(AlignedSegment));
+            }
         }
     }
+    return created;
+}
 
-    void* ret = top->head;
-    top->head = *static_cast<void**>(ret);
+template<typename T, class Mtx, size_t COUNT, size_t ALIGN, class Layout, class Provider>
+size_t Allocator<T, Mtx, COUNT, ALIGN, Layout, Provider>::Reduce(size_t count) {
+    if constexpr(LOCK_FREE) {
+        return 0; // chunks of any segment may be in the stack
+    }
+
+    [[maybe_unused]] LockGuard _(mtx);
+    return FreeBlock(count, UINT64_MAX);
+}
 
-    ++top->used;
+template<typename T, class Mtx, size_t COUNT, size_t ALIGN, class Layout, class Provider>
+size_t Allocator<T, Mtx, COUNT, ALIGN, Layout, Provider>::Trim(uint64_t now) {
+    if constexpr(LOCK_FREE) {
+        return 0;
+    }
 
-    ++usage.chunk.used;
-    --usage.chunk.usable;
+    [[maybe_unused]] LockGuard _(mtx);
 
-    // first
-    if(top->used == 1) {
-        --usage.block.full;
-        ++usage.block.used;
+    retention.clock = now;
+    if(now < retention.decay) {
+        return 0;
     }
 
-    // last
-    if(top->used == CHUNK_COUNT) {
-        Segment* fulled = top;
+    uint64_t before  = now - retention.decay;
+    size_t   reduced = FreeBlock(SIZE_MAX, before);
 
-        // new head
-        top = top->next;
-        if(top) top->prev = nullptr;
+    // idle too long
+    while(idle.tail && idle.tail->stamp <= before) {
+        Release(idle, idle.tail);
+        ++reduced;
+    }
+    return reduced;
+}
+
+template<typename T, class Mtx, size_t COUNT, size_t ALIGN, class Layout, class Provider>
+size_t Allocator<T, Mtx, COUNT, ALIGN, Layout, Provider>::Steal(Allocator& other, size_t count) {
+    if constexpr(LOCK_FREE) {
+        return 0;
+    }
 
-        // unlink
-        fulled->next = nullptr;
-        fulled->prev = nullptr;
+    size_t stolen = 0;
+    while(stolen < count && &other != this) {
+        Segment* block;
 
-        ++usage.block.empty;
-        --usage.block.used;
+        // one lock at a time, two allocators may steal from each other
+        {
+            [[maybe_unused]] LockGuard _(other.mtx);
+            block = other.Donate();
+        }
+        if(!block) {
+            break;
+        }
+
+        [[maybe_unused]] LockGuard _(mtx);
+        Adopt(block);
+        ++stolen;
     }
+    return stolen;
+}
 
-    return ret;
+template<typename T, class Mtx, size_t COUNT, size_t ALIGN, class Layout, class Provider>
+void Allocator<T, Mtx, COUNT, ALIGN, Layout, Provider>::Retain(size_t blocks, size_t bytes) {
+    [[maybe_unused]] LockGuard _(mtx);
+
+    size_t byBytes  = (bytes + BLOCK_TOTAL_SIZE - 1) / BLOCK_TOTAL_SIZE;
+    retention.block = blocks < byBytes ? byBytes : blocks;
 }
 
-template<typename T, class Mtx, size_t COUNT, size_t ALIGN> void Allocator<T, Mtx, COUNT, ALIGN>::ReleaseChunk(void* p) {
-    Chunk*   ptr   = static_cast<Chunk*>(p);
-    Segment* block = ptr->block;
+template<typename T, class Mtx, size_t COUNT, size_t ALIGN, class Layout, class Provider>
+void Allocator<T, Mtx, COUNT, ALIGN, Layout, Provider>::Decay(uint64_t ticks) {
+    [[maybe_unused]] LockGuard _(mtx);
+    retention.decay = ticks;
+}
 
-    // check
-    if(this != block->pool) {
-        throw std::runtime_error("Not part of this.");
+template<typename T, class Mtx, size_t COUNT, size_t ALIGN, class Layout, class Provider>
+auto Allocator<T, Mtx, COUNT, ALIGN, Layout, Provider>::Locker() const -> const LockType& {
+    return mtx;
+}
+
+template<typename T, class Mtx, size_t COUNT, size_t ALIGN, class Layout, class Provider>
+void Allocator<T, Mtx, COUNT, ALIGN, Layout, Provider>::Tag(size_t value) {
+    [[maybe_unused]] LockGuard _(mtx);
+    tag = value;
+}
+
+template<typename T, class Mtx, size_t COUNT, size_t ALIGN, class Layout, class Provider>
+void* Allocator<T, Mtx, COUNT, ALIGN, Layout, Provider>::GetChunck() {
+    void* ret;
+    return GetChunks(&ret, 1) ? ret : nullptr;
+}
+
+template<typename T, class Mtx, size_t COUNT, size_t ALIGN, class Layout, class Provider> auto Allocator<T, Mtx, COUNT, ALIGN, Layout, Provider>::Top() -> Segment* {
+    Segment* top = partial.head;
+    if(top) {
+        return top;
+    }
+
+    // decommitted segment
+    if(full.head == nullptr && idle.head != nullptr) {
+        top = idle.head;
+        Commit(top);
+    }
+
+    else {
+        if(full.head == nullptr) {
+            if(NewBlock() == false) {
+                telemetry.Fail();
+                return nullptr;
+            }
+        }
+
+        // hottest free segment
+        top = full.head;
+        full.Erase(top);
+        --usage.block.full;
     }
 
-    ptr->next   = block->head; // linking
-    block->head = p;           // push
+    partial.Push(top);
+    ++usage.block.used;
+    return top;
+}
 
-    --block->used;
-    --usage.chunk.used;
-    ++usage.chunk.usable;
+template<typename T, class Mtx, size_t COUNT, size_t ALIGN, class Layout, class Provider> size_t Allocator<T, Mtx, COUNT, ALIGN, Layout, Provider>::GetChunks(void** out, size_t count) {
+    size_t got = 0;
 
-    // empty -> usable
-    if(block->used == CHUNK_COUNT - 1) {
+    while(got < count) {
+        Segment* top = Top();
         if(!top) {
-            top = block;
-        } else {
-            block->next       = top;   // new head
-            top               = block; // stack push
-            block->next->prev = block; // double linked
+            break;
         }
 
-        --usage.block.empty;
-        ++usage.block.used;
-    }
+        // run of one segment
+        size_t run = CHUNK_COUNT - top->used;
+        if(run > count - got) {
+            run = count - got;
+        }
+
+        for(size_t i = 0; i < run; ++i) {
+            void* ret = top->head;
+
+            // never used
+            if(ret == nullptr) {
+                AlignedChunk* chunk = reinterpret_cast<AlignedChunk*>(reinterpret_cast<AlignedSegment*>(top) + 1) + top->carved;
+                if constexpr(!MASKED) chunk->block = top;
 
-    // full -> unlink
-    if(block->used == 0) {
-        if(block == top) {
-            if(block->next == nullptr) {
-                return;
+                ++top->carved;
+                ret = &chunk->data;
             }
+            else top->head = *static_cast<void**>(ret);
 
-            top       = top->next;
-            top->prev = nullptr;
+            out[got++] = ret;
         }
 
-        if(block->next != nullptr) {
-            block->next->prev = block->prev;
-            block->next       = nullptr;
+        top->used += run;
+
+        usage.chunk.used   += run;
+        usage.chunk.usable -= run;
+
+        // last
+        if(top->used == CHUNK_COUNT) {
+            partial.Erase(top);
+            empty.Push(top);
+
+            ++usage.block.empty;
+            --usage.block.used;
         }
+    }
+
+    if(got) {
+        telemetry.Allocate(got, usage.chunk.used);
+    }
+    return got;
+}
+
+template<typename T, class Mtx, size_t COUNT, size_t ALIGN, class Layout, class Provider> void Allocator<T, Mtx, COUNT, ALIGN, Layout, Provider>::ReleaseChunk(void* p) {
+    ReleaseChunks(&p, 1);
+}
 
-        if(block->prev != nullptr) {
-            block->prev->next = block->next;
-            block->prev       = nullptr;
+template<typename T, class Mtx, size_t COUNT, size_t ALIGN, class Layout, class Provider> void Allocator<T, Mtx, COUNT, ALIGN, Layout, Provider>::ReleaseChunks(void* const* chunks, size_t count) {
+    size_t index = 0;
+
+    while(index < count) {
+        Segment* block = Owner(chunks[index]);
+
+        // check
+        if(this != block->pool) {
+            throw std::runtime_error("Not part of this.");
         }
 
-        freeable.push(block);
+        // run of one segment, linking
+        size_t run = 0;
+        do {
+            static_cast<Chunk*>(chunks[index])->next = block->head;
+            block->head                              = chunks[index];
+            ++index;
+            ++run;
+        } while(index < count && Owner(chunks[index]) == block);
+
+        bool wasEmpty = block->used == CHUNK_COUNT;
+
+        block->used        -= run;
+        usage.chunk.used   -= run;
+        usage.chunk.usable += run;
+
+        // empty -> usable
+        if(wasEmpty) {
+            empty.Erase(block);
+            partial.Push(block);
+
+            --usage.block.empty;
+            ++usage.block.used;
+        }
+
+        // usable -> full
+        if(block->used == 0) {
+            // keep last one, prevent free and expand repeatedly
+            if(block == partial.head && block->next == nullptr) {
+                continue;
+            }
+
+            partial.Erase(block);
+            full.Push(block);
+            block->stamp = retention.clock;
 
-        ++usage.block.full;
-        --usage.block.used;
+            ++usage.block.full;
+            --usage.block.used;
+        }
     }
+
+    telemetry.Deallocate(count, usage.chunk.used);
 }
 
-template<typename T, class Mtx, size_t COUNT, size_t ALIGN> bool Allocator<T, Mtx, COUNT, ALIGN>::NewBlock() {
-    Segment* newBlock = static_cast<Segment*>(_aligned_malloc(BLOCK_TOTAL_SIZE, ALIGNMENT));
+template<typename T, class Mtx, size_t COUNT, size_t ALIGN, class Layout, class Provider> bool Allocator<T, Mtx, COUNT, ALIGN, Layout, Provider>::NewBlock() {
+    Segment* newBlock = static_cast<Segment*>(Provider::Allocate(BLOCK_TOTAL_SIZE, BLOCK_ALIGNMENT));
     if(!newBlock) {
         return false;
     }
-    all.insert(newBlock);
 
-    AlignedChunk* cursor = reinterpret_cast<AlignedChunk*>(reinterpret_cast<AlignedSegment*>(newBlock) + 1);
+    newBlock->pool   = this;
+    newBlock->stamp  = retention.clock;
+    newBlock->next   = nullptr;
+    newBlock->prev   = nullptr;
+    newBlock->used   = 0;
+    newBlock->carved = 0;
+    newBlock->head   = nullptr;
+    newBlock->tag    = tag;
 
-    newBlock->pool = this;
-    newBlock->next = nullptr;
-    newBlock->prev = nullptr;
-    newBlock->used = 0;
-    newBlock->head = (&cursor->data);
+    if constexpr(LOCK_FREE) {
+        AlignedChunk* cursor = reinterpret_cast<AlignedChunk*>(reinterpret_cast<AlignedSegment*>(newBlock) + 1);
 
-    for(size_t index = 0; index < CHUNK_COUNT - 1; ++index) {
-        AlignedChunk* next = cursor + 1;
+        newBlock->carved = CHUNK_COUNT;
+        newBlock->head   = (&cursor->data);
 
-        cursor->next  = &next->data;
-        cursor->block = newBlock;
-        cursor        = next;
+        for(size_t index = 0; index < CHUNK_COUNT - 1; ++index) {
+            AlignedChunk* next = cursor + 1;
+
+            cursor->next = &next->data;
+            if constexpr(!MASKED) cursor->block = newBlock;
+            cursor = next;
+        }
+        cursor->next = nullptr;
+        if constexpr(!MASKED) cursor->block = newBlock;
+
+        // kept only for destruction
+        partial.Push(newBlock);
+
+        // push whole chain at once
+        uintptr_t old = list.load(std::memory_order_relaxed);
+        do {
+            cursor->next = Tagged::Pointer(old);
+        } while(!list.compare_exchange_weak(
+            old, Tagged::Next(old, newBlock->head), std::memory_order_release, std::memory_order_relaxed));
+
+        usage.block.total += 1;
+        usage.chunk.total += CHUNK_COUNT;
+        std::atomic_ref<size_t>(usage.chunk.usable).fetch_add(CHUNK_COUNT, std::memory_order_relaxed);
+
+        usage.block.byte      += BLOCK_TOTAL_SIZE - sizeof(AlignedSegment);
+        usage.block.committed += BLOCK_TOTAL_SIZE;
+        usage.block.reserved  += BLOCK_TOTAL_SIZE;
+        usage.chunk.byte      += CHUNK_SIZE * CHUNK_COUNT;
+
+        telemetry.Expand(usage.chunk.total, usage.block.committed);
+        return true;
     }
-    cursor->next  = nullptr;
-    cursor->block = newBlock;
+
+    full.Push(newBlock);
 
     usage.block.total  += 1;
     usage.block.full   += 1;
     usage.chunk.total  += CHUNK_COUNT;
     usage.chunk.usable += CHUNK_COUNT;
 
+    usage.block.byte      += BLOCK_TOTAL_SIZE - sizeof(AlignedSegment);
+    usage.block.committed += BLOCK_TOTAL_SIZE;
+    usage.block.reserved  += BLOCK_TOTAL_SIZE;
+    usage.chunk.byte      += CHUNK_SIZE * CHUNK_COUNT;
+
+    telemetry.Expand(usage.chunk.total, usage.block.committed);
+    return true;
+}
+
+template<typename T, class Mtx, size_t COUNT, size_t ALIGN, class Layout, class Provider> size_t Allocator<T, Mtx, COUNT, ALIGN, Layout, Provider>::FreeBlock(size_t count, uint64_t before) {
+    size_t freed = 0;
+
+    // coldest first, keep retention.block and what Reserve promised
+    size_t keep = retention.block < retention.reserved ? retention.reserved : retention.block;
+    while(freed < count && usage.block.full > keep) {
+        Segment* block = full.tail;
+        if(block->stamp > before) {
+            break;
+        }
+
+        if constexpr(Provider::DECOMMIT) Decommit(block);
+        else Release(full, block);
+        ++freed;
+    }
+    return freed;
+}
+
+template<typename T, class Mtx, size_t COUNT, size_t ALIGN, class Layout, class Provider> void Allocator<T, Mtx, COUNT, ALIGN, Layout, Provider>::Release(List& from, Segment* block) {
+    from.Erase(block);
+
+    if(&from == &idle) {
+        uint8_t* begin;
+        size_t   size;
+        Range(block, begin, size);
+
+        usage.block.idle      -= 1;
+        usage.block.committed -= BLOCK_TOTAL_SIZE - size;
+    }
+    else {
+        usage.block.full      -= 1;
+        usage.block.committed -= BLOCK_TOTAL_SIZE;
+    }
+
+    Provider::Free(block, BLOCK_TOTAL_SIZE, BLOCK_ALIGNMENT);
+
+    usage.block.total    -= 1;
+    usage.block.reserved -= BLOCK_TOTAL_SIZE;
+    usage.chunk.usable   -= CHUNK_COUNT;
+    usage.chunk.total    -= CHUNK_COUNT;
+
+    usage.block.byte -= BLOCK_TOTAL_SIZE - sizeof(AlignedSegment);
+    usage.chunk.byte -= CHUNK_SIZE * CHUNK_COUNT;
+
+    telemetry.Reduce(usage.chunk.total, usage.block.committed);
+}
+
+template<typename T, class Mtx, size_t COUNT, size_t ALIGN, class Layout, class Provider> void Allocator<T, Mtx, COUNT, ALIGN, Layout, Provider>::Decommit(Segment* block) {
+    uint8_t* begin;
+    size_t   size;
+    Range(block, begin, size);
+
+    // smaller than a page
+    if(size == 0) {
+        Release(full, block);
+        return;
+    }
+
+    if constexpr(Provider::DECOMMIT) {
+        Provider::Decommit(begin, size);
+    }
+
+    // carve again, free list was in the dropped pages
+    block->head   = nullptr;
+    block->carved = 0;
+    block->stamp  = retention.clock;
+
+    full.Erase(block);
+    idle.Push(block);
+
+    usage.block.full      -= 1;
+    usage.block.idle      += 1;
+    usage.block.committed -= size;
+
+    telemetry.Reduce(usage.chunk.total, usage.block.committed);
+}
+
+template<typename T, class Mtx, size_t COUNT, size_t ALIGN, class Layout, class Provider> void Allocator<T, Mtx, COUNT, ALIGN, Layout, Provider>::Commit(Segment* block) {
+    uint8_t* begin;
+    size_t   size;
+    Range(block, begin, size);
+
+    if constexpr(Provider::DECOMMIT) {
+        Provider::Commit(begin, size);
+    }
+
+    idle.Erase(block);
+    block->stamp = retention.clock; // usable from now, not since decommit
+
+    usage.block.idle      -= 1;
+    usage.block.committed += size;
+
+    telemetry.Resize(usage.chunk.total, usage.block.committed);
+}
+
+template<typename T, class Mtx, size_t COUNT, size_t ALIGN, class Layout, class Provider> void Allocator<T, Mtx, COUNT, ALIGN, Layout, Provider>::Range(Segment* block, uint8_t*& begin, size_t& size) {
+    size = 0;
+
+    if constexpr(Provider::DECOMMIT) {
+        uintptr_t unit  = Provider::Granularity();
+        uintptr_t first = (reinterpret_cast<uintptr_t>(block) + sizeof(AlignedSegment) + unit - 1) & ~(unit - 1);
+        uintptr_t last  = (reinterpret_cast<uintptr_t>(block) + BLOCK_TOTAL_SIZE) & ~(unit - 1);
+
+        begin = reinterpret_cast<uint8_t*>(first);
+        size  = last > first ? last - first : 0;
+    }
+}
+
+template<typename T, class Mtx, size_t COUNT, size_t ALIGN, class Layout, class Provider> auto Allocator<T, Mtx, COUNT, ALIGN, Layout, Provider>::Donate() -> Segment* {
+    Segment* block = full.tail;
+    if(!block) {
+        return nullptr;
+    }
+
+    full.Erase(block);
+
+    usage.block.full      -= 1;
+    usage.block.total     -= 1;
+    usage.block.committed -= BLOCK_TOTAL_SIZE;
+    usage.block.reserved  -= BLOCK_TOTAL_SIZE;
+    usage.chunk.usable    -= CHUNK_COUNT;
+    usage.chunk.total     -= CHUNK_COUNT;
+
+    usage.block.byte -= BLOCK_TOTAL_SIZE - sizeof(AlignedSegment);
+    usage.chunk.byte -= CHUNK_SIZE * CHUNK_COUNT;
+
+    telemetry.Resize(usage.chunk.total, usage.block.committed);
+    return block;
+}
+
+template<typename T, class Mtx, size_t COUNT, size_t ALIGN, class Layout, class Provider> void Allocator<T, Mtx, COUNT, ALIGN, Layout, Provider>::Adopt(Segment* block) {
+    block->pool  = this;
+    block->stamp = retention.clock;
+    block->tag   = tag;
+    full.Push(block);
+
+    usage.block.full      += 1;
+    usage.block.total     += 1;
+    usage.block.committed += BLOCK_TOTAL_SIZE;
+    usage.block.reserved  += BLOCK_TOTAL_SIZE;
+    usage.chunk.usable    += CHUNK_COUNT;
+    usage.chunk.total     += CHUNK_COUNT;
+
     usage.block.byte += BLOCK_TOTAL_SIZE - sizeof(AlignedSegment);
     usage.chunk.byte += CHUNK_SIZE * CHUNK_COUNT;
 
-    if(top) freeable.push(newBlock);
-    else top = newBlock;
+    telemetry.Resize(usage.chunk.total, usage.block.committed);
+}
 
-    return true;
+template<typename T, class Mtx, size_t COUNT, size_t ALIGN, class Layout, class Provider> auto Allocator<T, Mtx, COUNT, ALIGN, Layout, Provider>::Bind() -> Magazine* {
+    std::shared_ptr<Magazine>* slot     = local.magazine;
+    Magazine*                  magazine = slot[0].get();
+    if(magazine && magazine->owner.load(std::memory_order_relaxed) == this) {
+        return magazine;
+    }
+
+    // slot of this instance, else unused, else least recent, moved to front
+    size_t i = 0;
+    while(i + 1 < Local::SIZE && slot[i]) {
+        Allocator* owner = slot[i]->owner.load(std::memory_order_relaxed);
+        if(owner == this || owner == nullptr) {
+            break;
+        }
+        ++i;
+    }
+    std::rotate(slot, slot + i, slot + i + 1);
+
+    magazine = slot[0].get();
+    if(magazine && magazine->owner.load(std::memory_order_relaxed) == this) {
+        return magazine;
+    }
+
+    // first call of this thread for this slot
+    if(!magazine) {
+        slot[0]  = std::make_shared<Magazine>();
+        magazine = slot[0].get();
+    }
+
+    // used by other instance, claimed before its destructor does
+    else if(Allocator* prev = magazine->owner.load(std::memory_order_acquire);
+            prev && magazine->owner.compare_exchange_strong(prev, nullptr, std::memory_order_acq_rel)) {
+        prev->Detach(magazine);
+    }
+
+    // owner destroyed, chunks went with its segments
+    else {
+        magazine->count = 0;
+    }
+
+    [[maybe_unused]] LockGuard _(mtx);
+    magazine->owner.store(this, std::memory_order_release);
+    magazines.push_back(slot[0]);
+    return magazine;
 }
 
-template<typename T, class Mtx, size_t COUNT, size_t ALIGN> void Allocator<T, Mtx, COUNT, ALIGN>::FreeBlock() {
-    while(freeable.empty() == false) {
-        all.erase(freeable.top());
+template<typename T, class Mtx, size_t COUNT, size_t ALIGN, class Layout, class Provider> void* Allocator<T, Mtx, COUNT, ALIGN, Layout, Provider>::Pop() {
+    Magazine* magazine = Bind();
 
-        _aligned_free(freeable.top());
-        freeable.pop();
+    // refill
+    if(magazine->count == 0) {
+        size_t batch = CACHE_SIZE > 1 ? CACHE_SIZE / 2 : 1;
 
-        usage.block.full   -= 1;
-        usage.block.total  -= 1;
-        usage.chunk.usable -= CHUNK_COUNT;
-        usage.chunk.total  -= CHUNK_COUNT;
+        if constexpr(LOCK_FREE) {
+            while(magazine->count < batch) {
+                void* chunk = PopFree();
+                if(!chunk) {
+                    break;
+                }
+                magazine->chunk[magazine->count++] = chunk;
+            }
+        }
+
+        else {
+            [[maybe_unused]] LockGuard _(mtx);
+            magazine->count = GetChunks(magazine->chunk, batch);
+        }
 
-        usage.block.byte -= BLOCK_TOTAL_SIZE - sizeof(AlignedSegment);
-        usage.chunk.byte -= CHUNK_SIZE * CHUNK_COUNT;
+        if(magazine->count == 0) {
+            return nullptr;
+        }
     }
+
+    return magazine->chunk[--magazine->count];
 }
 
-template<typename T, class Mtx, size_t COUNT, size_t ALIGN> Allocator<T, Mtx, COUNT, ALIGN>::Allocator(): Memory() {}
+template<typename T, class Mtx, size_t COUNT, size_t ALIGN, class Layout, class Provider> void Allocator<T, Mtx, COUNT, ALIGN, Layout, Provider>::Push(void* p) {
+    // check before caching, ReleaseChunk is deferred
+    if(this != Owner(p)->pool) {
+        throw std::runtime_error("Not part of this.");
+    }
 
-template<typename T, class Mtx, size_t COUNT, size_t ALIGN> Allocator<T, Mtx, COUNT, ALIGN>::~Allocator() {
-    for(typename std::set<Segment*>::iterator itr = all.begin(); itr != all.end(); ++itr) {
-        _aligned_free(*itr);
+    Magazine* magazine = Bind();
+
+    // flush
+    if(magazine->count == CACHE_SIZE) {
+        size_t keep = CACHE_SIZE / 2;
+
+        if constexpr(LOCK_FREE) {
+            while(magazine->count > keep) {
+                PushFree(magazine->chunk[--magazine->count]);
+            }
+        }
+
+        else {
+            [[maybe_unused]] LockGuard _(mtx);
+            ReleaseChunks(magazine->chunk + keep, magazine->count - keep);
+            magazine->count = keep;
+        }
+    }
+
+    magazine->chunk[magazine->count++] = p;
+}
+
+template<typename T, class Mtx, size_t COUNT, size_t ALIGN, class Layout, class Provider> void Allocator<T, Mtx, COUNT, ALIGN, Layout, Provider>::Detach(Magazine* magazine) {
+    [[maybe_unused]] LockGuard _(mtx);
+
+    if constexpr(LOCK_FREE) {
+        while(magazine->count) {
+            PushFree(magazine->chunk[--magazine->count]);
+        }
+    }
+    else {
+        ReleaseChunks(magazine->chunk, magazine->count);
+        magazine->count = 0;
+    }
+
+    for(size_t i = 0; i < magazines.size(); ++i) {
+        if(magazines[i].get() == magazine) {
+            magazines[i] = std::move(magazines.back());
+            magazines.pop_back();
+            break;
+        }
+    }
+}
+
+template<typename T, class Mtx, size_t COUNT, size_t ALIGN, class Layout, class Provider> bool Allocator<T, Mtx, COUNT, ALIGN, Layout, Provider>::Abandon() {
+    [[maybe_unused]] LockGuard _(mtx);
+
+    for(size_t i = 0; i < magazines.size();) {
+        // claimed by an exiting thread: stays listed until its Detach is done
+        Allocator* owner = this;
+        if(!magazines[i]->owner.compare_exchange_strong(owner, nullptr, std::memory_order_acq_rel)) {
+            ++i;
+            continue;
+        }
+        magazines[i] = std::move(magazines.back());
+        magazines.pop_back();
+    }
+    return magazines.empty();
+}
+
+template<typename T, class Mtx, size_t COUNT, size_t ALIGN, class Layout, class Provider> void* Allocator<T, Mtx, COUNT, ALIGN, Layout, Provider>::PopFree() {
+    uintptr_t old = list.load(std::memory_order_acquire);
+
+    while(true) {
+        void* chunk = Tagged::Pointer(old);
+
+        // expand, only one thread
+        if(!chunk) {
+            [[maybe_unused]] LockGuard _(mtx);
+
+            old = list.load(std::memory_order_acquire);
+            if(Tagged::Pointer(old) == nullptr) {
+                if(NewBlock() == false) {
+                    telemetry.Fail();
+                    return nullptr;
+                }
+                old = list.load(std::memory_order_acquire);
+            }
+            continue;
+        }
+
+        // stale value is rejected by version
+        void* next = *static_cast<void**>(chunk);
+        if(list.compare_exchange_weak(old, Tagged::Next(old, next), std::memory_order_acquire, std::memory_order_acquire)) {
+            size_t used = std::atomic_ref<size_t>(usage.chunk.used).fetch_add(1, std::memory_order_relaxed) + 1;
+            std::atomic_ref<size_t>(usage.chunk.usable).fetch_sub(1, std::memory_order_relaxed);
+
+            telemetry.Allocate(1, used);
+            return chunk;
+        }
+    }
+}
+
+template<typename T, class Mtx, size_t COUNT, size_t ALIGN, class Layout, class Provider> void Allocator<T, Mtx, COUNT, ALIGN, Layout, Provider>::PushFree(void* p) {
+    if(this != Owner(p)->pool) {
+        throw std::runtime_error("Not part of this.");
     }
+
+    uintptr_t old = list.load(std::memory_order_relaxed);
+    do {
+        *static_cast<void**>(p) = Tagged::Pointer(old);
+    } while(!list.compare_exchange_weak(old, Tagged::Next(old, p), std::memory_order_release, std::memory_order_relaxed));
+
+    size_t used = std::atomic_ref<size_t>(usage.chunk.used).fetch_sub(1, std::memory_order_relaxed) - 1;
+    std::atomic_ref<size_t>(usage.chunk.usable).fetch_add(1, std::memory_order_relaxed);
+
+    telemetry.Deallocate(1, used);
 }
 
-Memory::Memory(): INFO(usage) {}
+template<typename T, class Mtx, size_t COUNT, size_t ALIGN, class Layout, class Provider> Allocator<T, Mtx, COUNT, ALIGN, Layout, Provider>::Local::~Local() {
+    for(std::shared_ptr<Magazine>& slot : magazine) {
+        if(!slot) {
+            continue;
+        }
+
+        // claimed: owner waits in its destructor until Detach is done
+        Allocator* owner = slot->owner.load(std::memory_order_acquire);
+        if(owner && slot->owner.compare_exchange_strong(owner, nullptr, std::memory_order_acq_rel)) {
+            owner->Detach(slot.get()); // return to shared segments
+        }
+    }
+}
+
+template<typename T, class Mtx, size_t COUNT, size_t ALIGN, class Layout, class Provider> Allocator<T, Mtx, COUNT, ALIGN, Layout, Provider>::Allocator():
+    Memory(), telemetry({ typeid(T).name(), CHUNK_SIZE, CHUNK_COUNT, ALIGNMENT, BLOCK_TOTAL_SIZE }, LOCK_FREE) {
+    usage.chunk.footprint = (BLOCK_TOTAL_SIZE + CHUNK_COUNT - 1) / CHUNK_COUNT;
+}
+
+template<typename T, class Mtx, size_t COUNT, size_t ALIGN, class Layout, class Provider>
+auto Allocator<T, Mtx, COUNT, ALIGN, Layout, Provider>::Owner(void* p) -> Segment* {
+    if constexpr(MASKED) {
+        return reinterpret_cast<Segment*>(reinterpret_cast<uintptr_t>(p) & ~(BLOCK_TOTAL_SIZE - 1));
+    }
+    else {
+        return static_cast<Chunk*>(p)->block;
+    }
+}
+
+template<typename T, class Mtx, size_t COUNT, size_t ALIGN, class Layout, class Provider> Allocator<T, Mtx, COUNT, ALIGN, Layout, Provider>::~Allocator() {
+    // chunks left in magazines are released with their segments
+    while(!Abandon()) {
+        std::this_thread::yield(); // an exiting thread is in Detach
+    }
+
+    List* lists[] = { &full, &partial, &empty, &idle };
+    for(List* list : lists) {
+        Segment* block = list->head;
+        while(block) {
+            Segment* next = block->next;
+            Provider::Free(block, BLOCK_TOTAL_SIZE, BLOCK_ALIGNMENT);
+            block = next;
+        }
+    }
+}
+
+inline Memory::Memory(): INFO(usage) {}
+
+inline void Memory::List::Push(Segment* block) {
+    block->prev = nullptr;
+    block->next = head;
+
+    if(head) head->prev = block;
+    else tail = block;
+    head = block;
+}
+
+inline void Memory::List::Erase(Segment* block) {
+    if(block->prev) block->prev->next = block->next;
+    else head = block->next;
+
+    if(block->next) block->next->prev = block->prev;
+    else tail = block->prev;
+
+    block->next = nullptr;
+    block->prev = nullptr;
+}
+
+inline Memory::Usage& Memory::Usage::operator+=(const Usage& other) {
+    chunk.usable += other.chunk.usable;
+    chunk.used   += other.chunk.used;
+    chunk.total  += other.chunk.total;
+    chunk.byte   += other.chunk.byte;
+
+    block.used  += other.block.used;
+    block.full  += other.block.full;
+    block.empty += other.block.empty;
+    block.total += other.block.total;
+    block.byte  += other.block.byte;
+
+    block.idle      += other.block.idle;
+    block.committed += other.block.committed;
+    block.reserved  += other.block.reserved;
+    return *this;
+}
+
+inline void* Memory::Tagged::Pointer(uintptr_t tagged) {
+    return reinterpret_cast<void*>(tagged & MASK);
+}
+
+inline uintptr_t Memory::Tagged::Next(uintptr_t prev, void* ptr) {
+    return ((prev | MASK) + 1) | reinterpret_cast<uintptr_t>(ptr);
+}
 
 #endif
\ No newline at end of file
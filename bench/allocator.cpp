@@ -0,0 +1,167 @@
+#include <cstdlib>
+#include <memory_resource>
+
+#ifdef LWE_BENCH_BOOST
+#    include <boost/pool/pool.hpp>
+#endif
+
+#include "allocator.hpp"
+#include "bench.hpp"
+#include "sharded.hpp"
+#include "sizeclass.hpp"
+
+/*
+    allocator
+    - alloc_free        : 64 allocations then 64 frees, one thread, ns per pair
+    - alloc_free_batch  : same with AllocateBatch / DeallocateBatch
+    - cross_thread      : producer allocates, consumer frees, ns per allocation on producer
+*/
+
+namespace {
+
+struct Object {
+    uint8_t data[64];
+};
+
+constexpr size_t BATCH = 64;
+
+/*
+    subjects, same face: Allocate / Deallocate
+*/
+template<class A> struct Pooled {
+    Object* Allocate() { return pool.template Allocate<Object>(); }
+    void    Deallocate(Object* ptr) { pool.Deallocate(ptr); }
+
+    A pool;
+};
+
+struct SizeClassed {
+    Object* Allocate() { return static_cast<Object*>(heap.Allocate(sizeof(Object))); }
+    void    Deallocate(Object* ptr) { heap.Deallocate(ptr); }
+
+    SizeClassAllocator<> heap;
+};
+
+struct Malloc {
+    Object* Allocate() { return static_cast<Object*>(std::malloc(sizeof(Object))); }
+    void    Deallocate(Object* ptr) { std::free(ptr); }
+};
+
+template<class Resource> struct Resourced {
+    Object* Allocate() { return static_cast<Object*>(resource.allocate(sizeof(Object), alignof(Object))); }
+    void    Deallocate(Object* ptr) { resource.deallocate(ptr, sizeof(Object), alignof(Object)); }
+
+    Resource resource;
+};
+
+#ifdef LWE_BENCH_BOOST
+struct BoostPool {
+    Object* Allocate() { return static_cast<Object*>(pool.malloc()); }
+    void    Deallocate(Object* ptr) { pool.free(ptr); }
+
+    boost::pool<> pool{ sizeof(Object) };
+};
+#endif
+
+template<class Subject> void AllocFree(Bench::Report& report, const char* subject) {
+    auto    target = std::make_unique<Subject>();
+    Object* ptr[BATCH];
+
+    report.Run("allocator", "alloc_free", subject, BATCH, [&] {
+        for(size_t i = 0; i < BATCH; ++i) {
+            ptr[i] = target->Allocate();
+            ptr[i]->data[0] = uint8_t(i);
+        }
+        for(size_t i = 0; i < BATCH; ++i) {
+            target->Deallocate(ptr[i]);
+        }
+        Bench::Escape(ptr);
+    });
+}
+
+template<class A> void AllocFreeBatch(Bench::Report& report, const char* subject) {
+    auto    target = std::make_unique<A>();
+    Object* ptr[BATCH];
+
+    report.Run("allocator", "alloc_free_batch", subject, BATCH, [&] {
+        size_t n = target->AllocateBatch(BATCH, ptr);
+        for(size_t i = 0; i < n; ++i) {
+            ptr[i]->data[0] = uint8_t(i);
+        }
+        target->DeallocateBatch({ ptr, n });
+        Bench::Escape(ptr);
+    });
+}
+
+template<class Subject> void CrossThread(Bench::Report& report, const char* subject) {
+    if(!report.Accept("allocator", "cross_thread")) {
+        return;
+    }
+
+    auto                           target  = std::make_unique<Subject>();
+    auto                           ring    = std::make_unique<Bench::Ring<Object*, 1024>>();
+    size_t                         samples = report.Count();
+    Bench::Samples                 produced;
+    Bench::Gate                    gate(2);
+
+    produced.reserve(samples);
+
+    std::thread consumer([&] {
+        gate.Wait();
+        for(size_t left = samples * BATCH; left;) {
+            Object* ptr;
+            if(!ring->Pop(ptr)) {
+                std::this_thread::yield();
+                continue;
+            }
+            target->Deallocate(ptr);
+            --left;
+        }
+    });
+
+    gate.Wait();
+    for(size_t i = 0; i < samples; ++i) {
+        Bench::Clock::time_point since = Bench::Clock::now();
+        for(size_t j = 0; j < BATCH; ++j) {
+            Object* ptr = target->Allocate();
+            ptr->data[0] = uint8_t(j);
+            while(!ring->Push(ptr)) {
+                std::this_thread::yield();
+            }
+        }
+        produced.push_back(Bench::Elapsed(since, BATCH));
+    }
+    consumer.join();
+
+    report.Add("allocator", "cross_thread", subject, 2, BATCH, std::move(produced));
+}
+
+} // namespace
+
+void BenchAllocator(Bench::Report& report) {
+    AllocFree<Malloc>(report, "malloc");
+    AllocFree<Resourced<std::pmr::unsynchronized_pool_resource>>(report, "pmr::unsynchronized_pool_resource");
+#ifdef LWE_BENCH_BOOST
+    AllocFree<BoostPool>(report, "boost::pool");
+#endif
+    AllocFree<Pooled<Allocator<Object>>>(report, "Allocator<void>");
+    AllocFree<Pooled<Allocator<Object, SpinLock>>>(report, "Allocator<SpinLock>");
+    AllocFree<Pooled<Allocator<Object, TTASLock>>>(report, "Allocator<TTASLock>");
+    AllocFree<Pooled<Allocator<Object, ThreadCache<SpinLock>>>>(report, "Allocator<ThreadCache<SpinLock>>");
+    AllocFree<Pooled<Allocator<Object, LockFree>>>(report, "Allocator<LockFree>");
+    AllocFree<Pooled<Allocator<Object, void, 64, 8, Masked>>>(report, "Allocator<void, Masked>");
+    AllocFree<SizeClassed>(report, "SizeClassAllocator<SpinLock>");
+
+    AllocFreeBatch<Allocator<Object>>(report, "Allocator<void>");
+    AllocFreeBatch<Allocator<Object, SpinLock>>(report, "Allocator<SpinLock>");
+
+    CrossThread<Malloc>(report, "malloc");
+    CrossThread<Resourced<std::pmr::synchronized_pool_resource>>(report, "pmr::synchronized_pool_resource");
+    CrossThread<Pooled<Allocator<Object, SpinLock>>>(report, "Allocator<SpinLock>");
+    CrossThread<Pooled<Allocator<Object, TTASLock>>>(report, "Allocator<TTASLock>");
+    CrossThread<Pooled<Allocator<Object, FutexLock>>>(report, "Allocator<FutexLock>");
+    CrossThread<Pooled<Allocator<Object, ThreadCache<SpinLock>>>>(report, "Allocator<ThreadCache<SpinLock>>");
+    CrossThread<Pooled<Allocator<Object, LockFree>>>(report, "Allocator<LockFree>");
+    CrossThread<Pooled<ShardedAllocator<Object>>>(report, "ShardedAllocator<SpinLock>");
+    CrossThread<SizeClassed>(report, "SizeClassAllocator<SpinLock>");
+}
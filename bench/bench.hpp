@@ -0,0 +1,154 @@
+#ifndef LWE_BENCH_HPP
+#define LWE_BENCH_HPP
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "config.h"
+#include "macro.h"
+
+/*
+    bench harness
+    - a sample is one batch of operations, timed once, divided by the batch
+    - percentiles are taken over samples, per operation nanoseconds
+    - every thread keeps its own samples, merged when the case ends
+    - report is JSON on stdout, progress on stderr
+
+    json
+
+    {
+        "lock_stats": false,
+        "threads": 8,
+        "results": [
+            { "suite": "allocator", "case": "alloc_free", "subject": "Allocator<void>", "threads": 1,
+              "batch": 64, "samples": 4096, "ns": { "mean": 9.1, "p50": 8.7, "p99": 14.2, "p999": 30.5, "max": 112.0 } }
+        ]
+    }
+
+    use
+
+    bench                      // every suite
+    bench allocator            // suite or case containing "allocator"
+    bench --scale 4 lock       // 4x samples
+    bench --threads 16 > base.json
+
+    void BenchSomething(Bench::Report& report) {
+        report.Run("suite", "case", "subject", 64, [&] {
+            for(size_t i = 0; i < 64; ++i) {
+                // one operation
+            }
+        });
+    }
+*/
+class Bench {
+public:
+    NO_INSTANTIABLE(Bench);
+
+public:
+    using Clock   = std::chrono::steady_clock;
+    using Samples = std::vector<double>; // ns per operation
+
+public:
+    struct Option {
+        std::string filter;      // substring of suite or case, empty: all
+        size_t      samples = 4096;
+        size_t      threads = 0; // 0: hardware concurrency, at least 2
+    };
+
+    struct Result {
+        std::string suite;
+        std::string name;
+        std::string subject;
+        size_t      threads;
+        size_t      batch;
+        size_t      samples;
+
+        struct {
+            double mean;
+            double p50;
+            double p99;
+            double p999;
+            double max;
+        } ns;
+    };
+
+public:
+    class Report {
+    public:
+        NO_COPYABLE(Report);
+        Report(const Option&);
+
+    public:
+        bool   Accept(const char* suite, const char* name) const; // filter
+        size_t Count() const; // samples per case
+        size_t Threads() const;
+
+    public:
+        // single thread, f runs batch operations, warmed up first
+        template<typename F> void Run(const char* suite, const char* name, const char* subject, size_t batch, F&& f);
+
+        // merged samples of any number of threads
+        void Add(const char* suite, const char* name, const char* subject, size_t threads, size_t batch, Samples&&);
+
+    public:
+        void Write(std::ostream&) const;
+
+    private:
+        Option              option;
+        std::vector<Result> results;
+    };
+
+public:
+    /*
+        wait all threads, then start at once
+    */
+    class Gate {
+    public:
+        NO_COPYABLE(Gate);
+        Gate(size_t);
+
+    public:
+        void Wait();
+
+    private:
+        std::atomic<size_t> count;
+    };
+
+public:
+    /*
+        single producer single consumer, cross thread hand-off
+    */
+    template<typename T, size_t N> class Ring {
+    public:
+        static_assert((N & (N - 1)) == 0, "N must be power of 2");
+
+    public:
+        bool Push(T);
+        bool Pop(T&);
+
+    private:
+        alignas(EConfig::MEMORY_CACHE_LINE_DEFAULT) std::atomic<size_t> head = 0;
+        alignas(EConfig::MEMORY_CACHE_LINE_DEFAULT) std::atomic<size_t> tail = 0;
+        alignas(EConfig::MEMORY_CACHE_LINE_DEFAULT) T slot[N];
+    };
+
+public:
+    static double Elapsed(Clock::time_point since, size_t batch); // ns per operation
+    static Result Summarize(Samples&);                           // sorted in place
+
+public:
+    template<typename T> static void Escape(T&&); // keep the value, no dead store elimination
+};
+
+void BenchAllocator(Bench::Report&);
+void BenchBuffer(Bench::Report&);
+void BenchPool(Bench::Report&);
+void BenchLock(Bench::Report&);
+
+#include "bench.ipp"
+#endif
@@ -0,0 +1,166 @@
+#include "bench.hpp"
+
+#ifdef LWE_BENCH_HPP
+
+#include <algorithm>
+#include <cstdio>
+#include <numeric>
+
+inline Bench::Report::Report(const Option& option): option(option) {
+    if(this->option.threads == 0) {
+        this->option.threads = std::max<size_t>(std::thread::hardware_concurrency(), 2);
+    }
+    if(this->option.samples == 0) {
+        this->option.samples = 1;
+    }
+}
+
+inline bool Bench::Report::Accept(const char* suite, const char* name) const {
+    if(option.filter.empty()) {
+        return true;
+    }
+    return std::string(suite).find(option.filter) != std::string::npos ||
+           std::string(name).find(option.filter) != std::string::npos;
+}
+
+inline size_t Bench::Report::Count() const {
+    return option.samples;
+}
+
+inline size_t Bench::Report::Threads() const {
+    return option.threads;
+}
+
+template<typename F> void Bench::Report::Run(const char* suite, const char* name, const char* subject, size_t batch, F&& f) {
+    if(!Accept(suite, name)) {
+        return;
+    }
+
+    // warm up, segments and caches in place
+    for(size_t i = 0; i < option.samples / 8 + 1; ++i) {
+        f();
+    }
+
+    Samples samples;
+    samples.reserve(option.samples);
+
+    for(size_t i = 0; i < option.samples; ++i) {
+        Clock::time_point since = Clock::now();
+        f();
+        samples.push_back(Elapsed(since, batch));
+    }
+    Add(suite, name, subject, 1, batch, std::move(samples));
+}
+
+inline void Bench::Report::Add(const char* suite, const char* name, const char* subject, size_t threads, size_t batch, Samples&& samples) {
+    if(samples.empty()) {
+        return;
+    }
+
+    Result result  = Summarize(samples);
+    result.suite   = suite;
+    result.name    = name;
+    result.subject = subject;
+    result.threads = threads;
+    result.batch   = batch;
+
+    std::fprintf(stderr, "%-10s %-18s %-36s p50 %9.1f ns  p99 %9.1f ns\n", suite, name, subject, result.ns.p50, result.ns.p99);
+    results.push_back(std::move(result));
+}
+
+inline void Bench::Report::Write(std::ostream& out) const {
+#ifdef LWE_LOCK_STATS
+    const char* stats = "true";
+#else
+    const char* stats = "false";
+#endif
+
+    char number[64];
+    auto fixed = [&](double value) -> const char* {
+        std::snprintf(number, sizeof(number), "%.2f", value);
+        return number;
+    };
+
+    out << "{\n";
+    out << "    \"lock_stats\": " << stats << ",\n";
+    out << "    \"threads\": " << option.threads << ",\n";
+    out << "    \"samples\": " << option.samples << ",\n";
+    out << "    \"results\": [";
+
+    for(size_t i = 0; i < results.size(); ++i) {
+        const Result& result = results[i];
+
+        out << (i ? ",\n" : "\n");
+        out << "        { \"suite\": \"" << result.suite << "\", \"case\": \"" << result.name << "\", \"subject\": \"" << result.subject << "\"";
+        out << ", \"threads\": " << result.threads << ", \"batch\": " << result.batch << ", \"samples\": " << result.samples;
+        out << ", \"ns\": { \"mean\": " << fixed(result.ns.mean);
+        out << ", \"p50\": " << fixed(result.ns.p50);
+        out << ", \"p99\": " << fixed(result.ns.p99);
+        out << ", \"p999\": " << fixed(result.ns.p999);
+        out << ", \"max\": " << fixed(result.ns.max) << " } }";
+    }
+
+    out << "\n    ]\n}\n";
+}
+
+inline Bench::Gate::Gate(size_t count): count(count) {}
+
+inline void Bench::Gate::Wait() {
+    count.fetch_sub(1, std::memory_order_acq_rel);
+    while(count.load(std::memory_order_acquire)) {
+        std::this_thread::yield();
+    }
+}
+
+template<typename T, size_t N> bool Bench::Ring<T, N>::Push(T value) {
+    size_t back = tail.load(std::memory_order_relaxed);
+    if(back - head.load(std::memory_order_acquire) == N) {
+        return false; // full
+    }
+    slot[back & (N - 1)] = value;
+    tail.store(back + 1, std::memory_order_release);
+    return true;
+}
+
+template<typename T, size_t N> bool Bench::Ring<T, N>::Pop(T& value) {
+    size_t front = head.load(std::memory_order_relaxed);
+    if(front == tail.load(std::memory_order_acquire)) {
+        return false; // empty
+    }
+    value = slot[front & (N - 1)];
+    head.store(front + 1, std::memory_order_release);
+    return true;
+}
+
+inline double Bench::Elapsed(Clock::time_point since, size_t batch) {
+    return std::chrono::duration<double, std::nano>(Clock::now() - since).count() / double(batch ? batch : 1);
+}
+
+inline auto Bench::Summarize(Samples& samples) -> Result {
+    std::sort(samples.begin(), samples.end());
+
+    auto at = [&](double q) -> double {
+        size_t index = size_t(q * double(samples.size()));
+        return samples[std::min(index, samples.size() - 1)];
+    };
+
+    Result result;
+    result.samples = samples.size();
+    result.ns.mean = std::accumulate(samples.begin(), samples.end(), 0.0) / double(samples.size());
+    result.ns.p50  = at(0.5);
+    result.ns.p99  = at(0.99);
+    result.ns.p999 = at(0.999);
+    result.ns.max  = samples.back();
+    return result;
+}
+
+template<typename T> void Bench::Escape(T&& value) {
+#if defined(__GNUC__) || defined(__clang__)
+    asm volatile("" : : "g"(&value) : "memory");
+#else
+    static volatile const void* sink;
+    sink = &value;
+#endif
+}
+
+#endif
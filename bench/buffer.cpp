@@ -0,0 +1,361 @@
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+
+#include "bench.hpp"
+#include "buffer.hpp"
+#include "bufferchain.hpp"
+#include "ring.hpp"
+#include "sharedbuffer.hpp"
+
+/*
+    buffer, 4096 byte
+    - construct : default construct and destroy
+    - copy      : copy construct and destroy, used prefix copied ("payload", full page: 4096 byte)
+    - move      : move construct and destroy, no copy
+    - bulk      : Create(64) / Release, one lock each
+    - fanout    : one payload to 64 holders, ns per holder
+    - scan      : "\r\n" at the end of a full page, Buffer::Find per Simd level
+    - scan_dense: same, page of '\r' (every byte a candidate)
+    - equal     : two equal full pages, Buffer::Equal per Simd level
+    - handoff   : Packet moved from one thread to another, ns per packet on the producer
+    - chain     : header prepended to a shared payload, exported and consumed; Prepare / Commit of a short read
+    subjects: Buffer<4096> (Uninitialized: no memset), SharedBuffer<4096> (count in chunk), BufferChain<4096>
+    baseline: malloc + memcpy, std::unique_ptr<char[]>, std::string_view::find, memcmp, std::mutex + std::deque, std::string
+*/
+
+namespace {
+
+constexpr size_t BATCH = 64;
+
+using Page = Buffer<4096>;
+
+void Construct(Bench::Report& report) {
+    report.Run("buffer", "construct", "Buffer<4096>", BATCH, [&] {
+        for(size_t i = 0; i < BATCH; ++i) {
+            Page buffer;
+            Bench::Escape(buffer);
+        }
+    });
+
+    report.Run("buffer", "construct", "malloc", BATCH, [&] {
+        for(size_t i = 0; i < BATCH; ++i) {
+            void* ptr = std::malloc(4096);
+            Bench::Escape(ptr);
+            std::free(ptr);
+        }
+    });
+}
+
+void Uninitialized(Bench::Report& report) {
+    report.Run("buffer", "construct", "Buffer<4096>::Uninitialized", BATCH, [&] {
+        for(size_t i = 0; i < BATCH; ++i) {
+            Page buffer{ Page::Uninitialized() };
+            Bench::Escape(buffer);
+        }
+    });
+}
+
+void Copy(Bench::Report& report) {
+    Page source = "payload";
+
+    report.Run("buffer", "copy", "Buffer<4096>", BATCH, [&] {
+        for(size_t i = 0; i < BATCH; ++i) {
+            Page copy = source;
+            Bench::Escape(copy);
+        }
+    });
+
+    Page page;
+    page.Fill('x');
+    report.Run("buffer", "copy", "Buffer<4096> full page", BATCH, [&] {
+        for(size_t i = 0; i < BATCH; ++i) {
+            Page copy = page;
+            Bench::Escape(copy);
+        }
+    });
+
+    Page target;
+    report.Run("buffer", "copy_assign", "Buffer<4096>", BATCH, [&] {
+        for(size_t i = 0; i < BATCH; ++i) {
+            target = source;
+            Bench::Escape(target);
+        }
+    });
+
+    std::unique_ptr<char[]> origin(new char[4096]());
+    report.Run("buffer", "copy", "malloc+memcpy", BATCH, [&] {
+        for(size_t i = 0; i < BATCH; ++i) {
+            char* ptr = static_cast<char*>(std::malloc(4096));
+            std::memcpy(ptr, origin.get(), 4096);
+            Bench::Escape(ptr);
+            std::free(ptr);
+        }
+    });
+}
+
+void Move(Bench::Report& report) {
+    Page source = "payload";
+
+    report.Run("buffer", "move", "Buffer<4096>", BATCH, [&] {
+        for(size_t i = 0; i < BATCH; ++i) {
+            Page moved = std::move(source);
+            source     = std::move(moved);
+            Bench::Escape(source);
+        }
+    });
+
+    std::unique_ptr<char[]> origin(new char[4096]());
+    report.Run("buffer", "move", "unique_ptr<char[]>", BATCH, [&] {
+        for(size_t i = 0; i < BATCH; ++i) {
+            std::unique_ptr<char[]> moved = std::move(origin);
+            origin                        = std::move(moved);
+            Bench::Escape(origin);
+        }
+    });
+}
+
+void Bulk(Bench::Report& report) {
+    report.Run("buffer", "bulk", "Buffer<4096>::Create", BATCH, [&] {
+        std::vector<Page> burst = Page::Create(BATCH);
+        Page::Release(burst);
+        Bench::Escape(burst);
+    });
+}
+
+void Fanout(Bench::Report& report) {
+    {
+        Page              source = "payload";
+        std::vector<Page> holders;
+        holders.reserve(BATCH);
+
+        report.Run("buffer", "fanout", "Buffer<4096>", BATCH, [&] {
+            for(size_t i = 0; i < BATCH; ++i) {
+                holders.push_back(source);
+            }
+            holders.clear();
+        });
+    }
+
+    {
+        SharedBuffer<4096>              source("payload");
+        std::vector<SharedBuffer<4096>> holders;
+        holders.reserve(BATCH);
+
+        report.Run("buffer", "fanout", "SharedBuffer<4096>", BATCH, [&] {
+            for(size_t i = 0; i < BATCH; ++i) {
+                holders.push_back(source);
+            }
+            holders.clear();
+        });
+    }
+}
+
+const char* Name(Simd::Level level) {
+    switch(level) {
+        case Simd::AVX2: return "Buffer<4096> AVX2";
+        case Simd::SSE2: return "Buffer<4096> SSE2";
+        default: return "Buffer<4096> SCALAR";
+    }
+}
+
+void Scan(Bench::Report& report) {
+    Page page;
+    page.Fill('x', 4094);
+    page.Append("\r\n", 2);
+
+    for(int level = Simd::Detect(); level >= Simd::SCALAR; --level) {
+        Simd::Use(Simd::Level(level));
+        report.Run("buffer", "scan", Name(Simd::Level(level)), 1, [&] {
+            Bench::Escape(page.Find("\r\n"));
+        });
+    }
+    Simd::Use(Simd::Detect());
+
+    std::string_view view = page.View();
+    report.Run("buffer", "scan", "std::string_view::find", 1, [&] {
+        Bench::Escape(view.find("\r\n"));
+    });
+
+    Page dense;
+    dense.Fill('\r', 4095);
+    dense.Append("\n", 1);
+
+    for(int level = Simd::Detect(); level >= Simd::SCALAR; --level) {
+        Simd::Use(Simd::Level(level));
+        report.Run("buffer", "scan_dense", Name(Simd::Level(level)), 1, [&] {
+            Bench::Escape(dense.Find("\r\n"));
+        });
+    }
+    Simd::Use(Simd::Detect());
+
+    std::string_view lines = dense.View();
+    report.Run("buffer", "scan_dense", "std::string_view::find", 1, [&] {
+        Bench::Escape(lines.find("\r\n"));
+    });
+}
+
+void Equal(Bench::Report& report) {
+    Page a, b;
+    a.Fill('x');
+    b.Fill('x');
+
+    for(int level = Simd::Detect(); level >= Simd::SCALAR; --level) {
+        Simd::Use(Simd::Level(level));
+        report.Run("buffer", "equal", Name(Simd::Level(level)), 1, [&] {
+            Bench::Escape(a.Equal(b.View()));
+        });
+    }
+    Simd::Use(Simd::Detect());
+
+    report.Run("buffer", "equal", "memcmp", 1, [&] {
+        Bench::Escape(std::memcmp(static_cast<char*>(a), static_cast<char*>(b), 4096) == 0);
+    });
+}
+
+/*
+    TryPush / TryPop of a ring, Push / Pop of the locked deque
+*/
+template<class Ring> struct Lockless {
+    std::unique_ptr<Ring> ring = std::make_unique<Ring>();
+
+    bool Push(Page& page) { return ring->TryPush(std::move(page)); }
+    bool Pop(Page& page) { return ring->TryPop(page); }
+};
+
+struct Locked {
+    std::mutex       mtx;
+    std::deque<Page> queue;
+
+    bool Push(Page& page) {
+        std::lock_guard<std::mutex> _(mtx);
+        queue.push_back(std::move(page));
+        return true;
+    }
+
+    bool Pop(Page& page) {
+        std::lock_guard<std::mutex> _(mtx);
+        if(queue.empty()) {
+            return false;
+        }
+        page = std::move(queue.front());
+        queue.pop_front();
+        return true;
+    }
+};
+
+template<class Queue> void Handoff(Bench::Report& report, const char* subject) {
+    if(!report.Accept("buffer", "handoff")) {
+        return;
+    }
+
+    Queue          queue;
+    size_t         samples = report.Count();
+    Bench::Samples produced;
+    Bench::Gate    gate(2);
+
+    produced.reserve(samples);
+
+    std::thread consumer([&] {
+        Page page{ Page::Uninitialized() };
+
+        gate.Wait();
+        for(size_t left = samples * BATCH; left;) {
+            if(!queue.Pop(page)) {
+                std::this_thread::yield();
+                continue;
+            }
+            Bench::Escape(page);
+            --left;
+        }
+    });
+
+    std::vector<Page> pages = Page::Create(BATCH, Page::Uninitialized());
+
+    gate.Wait();
+    for(size_t i = 0; i < samples; ++i) {
+        Bench::Clock::time_point since = Bench::Clock::now();
+        for(Page& page : pages) {
+            while(!queue.Push(page)) {
+                std::this_thread::yield();
+            }
+        }
+        produced.push_back(Bench::Elapsed(since, BATCH));
+
+        // moved-from pages get a buffer back, outside the measure
+        for(Page& page : pages) {
+            page = Page(Page::Uninitialized());
+        }
+    }
+    consumer.join();
+
+    report.Add("buffer", "handoff", subject, 2, BATCH, std::move(produced));
+}
+
+void Chain(Bench::Report& report) {
+    using Chained = BufferChain<4096>;
+
+    Chained::Segment payload{ Chained::Segment::Uninitialized() };
+    std::memset(payload.Mutable(), 'x', payload.Size());
+    const char header[16] = "header";
+
+    report.Run("buffer", "chain", "BufferChain<4096>", BATCH, [&] {
+        for(size_t i = 0; i < BATCH; ++i) {
+            Chained        out;
+            Chained::IoVec io[4];
+            out.Append(payload);
+            out.Prepend(header, sizeof(header));
+            Bench::Escape(out.Export(io, 4));
+            Bench::Escape(io);
+            out.Consume(out.Size());
+        }
+    });
+
+    report.Run("buffer", "chain", "std::string", BATCH, [&] {
+        for(size_t i = 0; i < BATCH; ++i) {
+            std::string out(header, sizeof(header));
+            out.append(payload.View());
+            Bench::Escape(out);
+        }
+    });
+
+    Chained        in;
+    Chained::IoVec io[4];
+    report.Run("buffer", "chain_read", "BufferChain<4096>", BATCH, [&] {
+        for(size_t i = 0; i < BATCH; ++i) {
+            size_t count = in.Prepare(3 * 4096, io, 4);
+            size_t got   = 0;
+            for(size_t j = 0; j < count && j < 2; ++j) {
+                std::memset(io[j].iov_base, 'y', io[j].iov_len); // short read: two of three
+                got += io[j].iov_len;
+            }
+            in.Commit(got);
+            in.Consume(got);
+        }
+    });
+}
+
+void Handoffs(Bench::Report& report) {
+    Handoff<Lockless<SPSCRing<Page>>>(report, "SPSCRing<Packet>");
+    Handoff<Lockless<MPMCRing<Page>>>(report, "MPMCRing<Packet>");
+    Handoff<Locked>(report, "std::mutex + std::deque");
+}
+
+} // namespace
+
+void BenchBuffer(Bench::Report& report) {
+    Construct(report);
+    Uninitialized(report);
+    Copy(report);
+    Move(report);
+    Bulk(report);
+    Fanout(report);
+    Scan(report);
+    Equal(report);
+    Chain(report);
+    Handoffs(report);
+}
@@ -0,0 +1,85 @@
+#include <mutex>
+
+#include "bench.hpp"
+#include "lock.hpp"
+
+/*
+    lock
+    - uncontended : lock, increment, unlock on one thread
+    - contended   : every thread on one lock, ns per acquisition seen by a thread
+*/
+
+namespace {
+
+constexpr size_t BATCH = 64;
+
+template<class Mtx> void Uncontended(Bench::Report& report, const char* subject) {
+    Mtx      mtx;
+    uint64_t counter = 0;
+
+    report.Run("lock", "uncontended", subject, BATCH, [&] {
+        for(size_t i = 0; i < BATCH; ++i) {
+            mtx.lock();
+            ++counter;
+            mtx.unlock();
+        }
+        Bench::Escape(counter);
+    });
+}
+
+template<class Mtx> void Contended(Bench::Report& report, const char* subject) {
+    if(!report.Accept("lock", "contended")) {
+        return;
+    }
+
+    size_t threads = report.Threads();
+    size_t samples = report.Count() / threads + 1;
+
+    Mtx                         mtx;
+    uint64_t                    counter = 0;
+    std::vector<Bench::Samples> local(threads);
+    std::vector<std::thread>    workers;
+    Bench::Gate                 gate(threads);
+
+    for(size_t t = 0; t < threads; ++t) {
+        workers.emplace_back([&, t] {
+            local[t].reserve(samples);
+            gate.Wait();
+
+            for(size_t i = 0; i < samples; ++i) {
+                Bench::Clock::time_point since = Bench::Clock::now();
+                for(size_t j = 0; j < BATCH; ++j) {
+                    mtx.lock();
+                    ++counter;
+                    mtx.unlock();
+                }
+                local[t].push_back(Bench::Elapsed(since, BATCH));
+            }
+        });
+    }
+
+    Bench::Samples merged;
+    for(size_t t = 0; t < threads; ++t) {
+        workers[t].join();
+        merged.insert(merged.end(), local[t].begin(), local[t].end());
+    }
+    Bench::Escape(counter);
+
+    report.Add("lock", "contended", subject, threads, BATCH, std::move(merged));
+}
+
+template<class Mtx> void Both(Bench::Report& report, const char* subject) {
+    Uncontended<Mtx>(report, subject);
+    Contended<Mtx>(report, subject);
+}
+
+} // namespace
+
+void BenchLock(Bench::Report& report) {
+    Both<std::mutex>(report, "std::mutex");
+    Both<SpinLock>(report, "SpinLock");
+    Both<TTASLock>(report, "TTASLock");
+    Both<TicketLock>(report, "TicketLock");
+    Both<MCSLock>(report, "MCSLock");
+    Both<FutexLock>(report, "FutexLock");
+}
@@ -0,0 +1,48 @@
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+
+#include "bench.hpp"
+
+/*
+    bench [--samples N] [--scale N] [--threads N] [filter]
+*/
+int main(int argc, char** argv) {
+    Bench::Option option;
+
+    for(int i = 1; i < argc; ++i) {
+        const char* arg  = argv[i];
+        const char* next = i + 1 < argc ? argv[i + 1] : nullptr;
+
+        if(!std::strcmp(arg, "--samples") && next) {
+            option.samples = std::strtoull(next, nullptr, 10);
+            ++i;
+        }
+        else if(!std::strcmp(arg, "--scale") && next) {
+            option.samples *= std::strtoull(next, nullptr, 10);
+            ++i;
+        }
+        else if(!std::strcmp(arg, "--threads") && next) {
+            option.threads = std::strtoull(next, nullptr, 10);
+            ++i;
+        }
+        else if(!std::strcmp(arg, "--help") || !std::strcmp(arg, "-h")) {
+            std::fprintf(stderr, "usage: %s [--samples N] [--scale N] [--threads N] [filter]\n", argv[0]);
+            return 0;
+        }
+        else {
+            option.filter = arg;
+        }
+    }
+
+    Bench::Report report(option);
+
+    BenchAllocator(report);
+    BenchBuffer(report);
+    BenchPool(report);
+    BenchLock(report);
+
+    report.Write(std::cout);
+    return 0;
+}
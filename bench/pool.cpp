@@ -0,0 +1,247 @@
+#include <functional>
+#include <mutex>
+#include <random>
+#include <thread>
+#include <unordered_map>
+
+#include "bench.hpp"
+#include "concurrentpool.hpp"
+#include "densepool.hpp"
+#include "pool.hpp"
+
+/*
+    pool, 32 byte values
+    - insert_erase    : insert 64 then erase 64, ns per pair
+    - find            : 64 lookups of random live ids among 4096
+    - iterate         : visit 4096 values, ns per value
+    - parallel_reduce : sum of 4096 values on Executor::Instance(), grain 256, ns per value
+    - shared          : Threads() threads, 64 ops of 1 insert + 1 erase per 32 finds, ns per op
+    subjects: Pool, DensePool (contiguous values)
+    baseline: std::unordered_map<size_t, Value> keyed by counter
+              Pool behind a std::mutex for shared
+*/
+
+namespace {
+
+struct Value {
+    uint64_t data[4];
+};
+
+constexpr size_t BATCH = 64;
+constexpr size_t LIVE  = 4096;
+
+void InsertErase(Bench::Report& report) {
+    {
+        Pool<Value> pool;
+        ID          id[BATCH];
+
+        report.Run("pool", "insert_erase", "Pool", BATCH, [&] {
+            for(size_t i = 0; i < BATCH; ++i) {
+                id[i] = pool.Insert(Value{ { i } });
+            }
+            for(size_t i = 0; i < BATCH; ++i) {
+                pool.Erase(id[i]);
+            }
+        });
+    }
+
+    {
+        DensePool<Value> pool;
+        ID               id[BATCH];
+
+        report.Run("pool", "insert_erase", "DensePool", BATCH, [&] {
+            for(size_t i = 0; i < BATCH; ++i) {
+                id[i] = pool.Insert(Value{ { i } });
+            }
+            for(size_t i = 0; i < BATCH; ++i) {
+                pool.Erase(id[i]);
+            }
+        });
+    }
+
+    {
+        std::unordered_map<size_t, Value> map;
+        size_t                            next = 0;
+        size_t                            key[BATCH];
+
+        report.Run("pool", "insert_erase", "std::unordered_map", BATCH, [&] {
+            for(size_t i = 0; i < BATCH; ++i) {
+                key[i] = ++next;
+                map.emplace(key[i], Value{ { i } });
+            }
+            for(size_t i = 0; i < BATCH; ++i) {
+                map.erase(key[i]);
+            }
+        });
+    }
+}
+
+void Find(Bench::Report& report) {
+    std::mt19937_64 random(42);
+
+    {
+        Pool<Value>     pool;
+        std::vector<ID> ids;
+        for(size_t i = 0; i < LIVE; ++i) {
+            ids.push_back(pool.Insert(Value{ { i } }));
+        }
+
+        report.Run("pool", "find", "Pool", BATCH, [&] {
+            uint64_t sum = 0;
+            for(size_t i = 0; i < BATCH; ++i) {
+                sum += pool.Find(ids[random() % LIVE])->data[0];
+            }
+            Bench::Escape(sum);
+        });
+
+        report.Run("pool", "iterate", "Pool", LIVE, [&] {
+            uint64_t sum = 0;
+            for(auto it = pool.Begin(); it != pool.End(); ++it) {
+                sum += it->data[0];
+            }
+            Bench::Escape(sum);
+        });
+
+        report.Run("pool", "parallel_reduce", "Pool", LIVE, [&] {
+            Bench::Escape(pool.ParallelReduce<uint64_t>(0, [](Value& value) { return value.data[0]; }, std::plus<>(), LIVE / 16));
+        });
+    }
+
+    {
+        DensePool<Value> pool;
+        std::vector<ID>  ids;
+        for(size_t i = 0; i < LIVE; ++i) {
+            ids.push_back(pool.Insert(Value{ { i } }));
+        }
+
+        report.Run("pool", "find", "DensePool", BATCH, [&] {
+            uint64_t sum = 0;
+            for(size_t i = 0; i < BATCH; ++i) {
+                sum += pool.Find(ids[random() % LIVE])->data[0];
+            }
+            Bench::Escape(sum);
+        });
+
+        report.Run("pool", "iterate", "DensePool", LIVE, [&] {
+            uint64_t sum = 0;
+            for(Value& value : pool.Data()) {
+                sum += value.data[0];
+            }
+            Bench::Escape(sum);
+        });
+    }
+
+    {
+        std::unordered_map<size_t, Value> map;
+        for(size_t i = 0; i < LIVE; ++i) {
+            map.emplace(i + 1, Value{ { i } });
+        }
+
+        report.Run("pool", "find", "std::unordered_map", BATCH, [&] {
+            uint64_t sum = 0;
+            for(size_t i = 0; i < BATCH; ++i) {
+                sum += map.find(random() % LIVE + 1)->second.data[0];
+            }
+            Bench::Escape(sum);
+        });
+
+        report.Run("pool", "iterate", "std::unordered_map", LIVE, [&] {
+            uint64_t sum = 0;
+            for(auto& [key, value] : map) {
+                sum += value.data[0];
+            }
+            Bench::Escape(sum);
+        });
+    }
+}
+
+// f(random, inserted, op) per op, inserted: last ID of this thread
+template<typename F> void Shared(Bench::Report& report, const char* subject, F&& f) {
+    size_t threads = report.Threads();
+    size_t samples = report.Count() / threads + 1;
+
+    std::vector<Bench::Samples> local(threads);
+    std::vector<std::thread>    workers;
+    Bench::Gate                 gate(threads);
+
+    for(size_t t = 0; t < threads; ++t) {
+        workers.emplace_back([&, t] {
+            std::mt19937_64 random(t);
+            ID              inserted;
+
+            local[t].reserve(samples);
+            gate.Wait();
+
+            for(size_t i = 0; i < samples; ++i) {
+                Bench::Clock::time_point since = Bench::Clock::now();
+                for(size_t j = 0; j < BATCH; ++j) {
+                    f(random, inserted, j);
+                }
+                local[t].push_back(Bench::Elapsed(since, BATCH));
+            }
+        });
+    }
+
+    Bench::Samples merged;
+    for(size_t t = 0; t < threads; ++t) {
+        workers[t].join();
+        merged.insert(merged.end(), local[t].begin(), local[t].end());
+    }
+
+    report.Add("pool", "shared", subject, threads, BATCH, std::move(merged));
+}
+
+void Shared(Bench::Report& report) {
+    if(!report.Accept("pool", "shared")) {
+        return;
+    }
+
+    {
+        Pool<Value>     pool;
+        std::mutex      mtx;
+        std::vector<ID> ids;
+        for(size_t i = 0; i < LIVE; ++i) {
+            ids.push_back(pool.Insert(Value{ { i } }));
+        }
+
+        Shared(report, "Pool + std::mutex", [&](std::mt19937_64& random, ID& inserted, size_t op) {
+            std::lock_guard lock(mtx);
+            if(op % 32 == 0) {
+                inserted = pool.Insert(Value{ { op } });
+            }
+            else if(op % 32 == 1) {
+                pool.Erase(inserted);
+            }
+            else Bench::Escape(pool.Find(ids[random() % LIVE])->data[0]);
+        });
+    }
+
+    {
+        ConcurrentPool<Value> pool;
+        std::vector<ID>       ids;
+        for(size_t i = 0; i < LIVE; ++i) {
+            ids.push_back(pool.Insert(Value{ { i } }));
+        }
+
+        Shared(report, "ConcurrentPool", [&](std::mt19937_64& random, ID& inserted, size_t op) {
+            if(op % 32 == 0) {
+                inserted = pool.Insert(Value{ { op } });
+            }
+            else if(op % 32 == 1) {
+                pool.Erase(inserted);
+            }
+            else {
+                Epoch::Guard guard;
+                Bench::Escape(pool.Find(ids[random() % LIVE])->data[0]);
+            }
+        });
+    }
+}
+
+} // namespace
+
+void BenchPool(Bench::Report& report) {
+    InsertErase(report);
+    Find(report);
+    Shared(report);
+}
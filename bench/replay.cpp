@@ -0,0 +1,369 @@
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <tuple>
+#include <unordered_map>
+#include <utility>
+
+#if defined(__linux__) || defined(__APPLE__)
+#    include <sys/resource.h>
+#endif
+
+#include "allocator.hpp"
+#include "bench.hpp"
+#include "trace.hpp"
+
+/*
+    replay [--lock spin|ttas|ticket|mcs|futex|cache|lockfree|malloc] [--count 16|64|256] [--ops chunk|id] [--pace] trace
+
+    - one thread per recorded thread, each runs its own records in time order
+    - a free recorded on another thread waits until the allocation is replayed
+    - sizes go to the power of 2 class above, 16 byte ~ 64 KiB, larger to malloc
+    - frees without allocation (before Start) are dropped, live chunks are freed untimed at the end
+    - every operation is timed, clock cost included
+
+    --ops chunk: Allocator allocate / deallocate records (default)
+    --ops id   : Pool insert / erase records, one object per ID lifetime
+    --pace     : hold every record until its recorded time, live set as recorded
+                 otherwise as fast as possible, a producer may run ahead of its consumer
+
+    output: JSON on stdout, throughput, allocate / deallocate ns percentiles, peak RSS
+*/
+
+namespace {
+
+/*
+    configuration under test
+*/
+class Subject {
+public:
+    virtual ~Subject() = default;
+
+public:
+    virtual void* Allocate(uint32_t size)          = 0;
+    virtual void  Deallocate(void*, uint32_t size) = 0;
+};
+
+class Malloc: public Subject {
+public:
+    void* Allocate(uint32_t size) override { return std::malloc(size); }
+    void  Deallocate(void* ptr, uint32_t) override { std::free(ptr); }
+};
+
+template<class Mtx, size_t COUNT> class Classes: public Subject {
+public:
+    static constexpr size_t CLASSES = 13; // 16 << 12 == 64 KiB
+
+    template<size_t I> using Class = Allocator<Block<(size_t(16) << I)>, Mtx, COUNT>;
+
+public:
+    void* Allocate(uint32_t size) override {
+        size_t index = Index(size);
+        if(index >= CLASSES) {
+            return std::malloc(size);
+        }
+
+        void* ptr = nullptr;
+        Visit(index, [&](auto& pool) { ptr = pool.template Allocate<void>(); });
+        return ptr;
+    }
+
+    void Deallocate(void* ptr, uint32_t size) override {
+        size_t index = Index(size);
+        if(index >= CLASSES) {
+            std::free(ptr);
+            return;
+        }
+        Visit(index, [&](auto& pool) { pool.Deallocate(ptr); });
+    }
+
+private:
+    static size_t Index(uint32_t size) {
+        size_t width = std::bit_width(uint32_t(size ? size - 1 : 0));
+        return width > 4 ? width - 4 : 0;
+    }
+
+    template<typename F> void Visit(size_t index, F&& f) {
+        [&]<size_t... I>(std::index_sequence<I...>) {
+            ((I == index ? (f(*std::get<I>(pools)), true) : false) || ...);
+        }(std::make_index_sequence<CLASSES>());
+    }
+
+    template<size_t... I> static auto Make(std::index_sequence<I...>) -> std::tuple<std::unique_ptr<Class<I>>...> {
+        return { std::make_unique<Class<I>>()... };
+    }
+
+private:
+    decltype(Make(std::make_index_sequence<CLASSES>())) pools = Make(std::make_index_sequence<CLASSES>());
+};
+
+template<class Mtx> std::unique_ptr<Subject> Counted(size_t count) {
+    switch(count) {
+    case 16: return std::make_unique<Classes<Mtx, 16>>();
+    case 64: return std::make_unique<Classes<Mtx, 64>>();
+    case 256: return std::make_unique<Classes<Mtx, 256>>();
+    }
+    throw std::runtime_error("Count not supported.");
+}
+
+std::unique_ptr<Subject> Create(const std::string& lock, size_t count) {
+    if(lock == "malloc") return std::make_unique<Malloc>();
+    if(lock == "spin") return Counted<SpinLock>(count);
+    if(lock == "ttas") return Counted<TTASLock>(count);
+    if(lock == "ticket") return Counted<TicketLock>(count);
+    if(lock == "mcs") return Counted<MCSLock>(count);
+    if(lock == "futex") return Counted<FutexLock>(count);
+    if(lock == "cache") return Counted<ThreadCache<SpinLock>>(count);
+    if(lock == "lockfree") return Counted<LockFree>(count);
+    throw std::runtime_error("Lock not supported.");
+}
+
+/*
+    trace to per thread steps
+*/
+struct Step {
+    uint64_t time; // ns since Start
+    uint32_t object;
+    uint32_t size;
+    bool     release;
+};
+
+struct Plan {
+    std::vector<std::vector<Step>> threads;
+    std::vector<uint32_t>          sizes;    // per object
+    std::vector<bool>              released; // per object
+    size_t                         dropped = 0;
+};
+
+Plan Prepare(const std::vector<Trace::Record>& records, bool ids) {
+    uint8_t create  = ids ? Trace::INSERT : Trace::ALLOCATE;
+    uint8_t destroy = ids ? Trace::ERASE : Trace::DEALLOCATE;
+
+    Plan                                   plan;
+    std::unordered_map<uint64_t, uint32_t> live; // chunk to object
+
+    for(const Trace::Record& record : records) {
+        if(record.op != create && record.op != destroy) {
+            continue;
+        }
+        if(record.thread >= plan.threads.size()) {
+            plan.threads.resize(record.thread + 1);
+        }
+
+        if(record.op == create) {
+            uint32_t object    = uint32_t(plan.sizes.size());
+            live[record.chunk] = object;
+            plan.sizes.push_back(record.size);
+            plan.released.push_back(false);
+            plan.threads[record.thread].push_back({ record.time, object, record.size, false });
+            continue;
+        }
+
+        auto itr = live.find(record.chunk);
+        if(itr == live.end()) {
+            ++plan.dropped;
+            continue;
+        }
+        plan.threads[record.thread].push_back({ record.time, itr->second, record.size, true });
+        plan.released[itr->second] = true;
+        live.erase(itr);
+    }
+    return plan;
+}
+
+/*
+    resident set, KiB
+*/
+void ResetPeak() {
+#if defined(__linux__)
+    std::ofstream("/proc/self/clear_refs") << "5"; // VmHWM = VmRSS
+#endif
+}
+
+size_t PeakRSS() {
+#if defined(__linux__)
+    std::ifstream status("/proc/self/status");
+    std::string   line;
+    while(std::getline(status, line)) {
+        if(line.rfind("VmHWM:", 0) == 0) {
+            return std::strtoull(line.c_str() + 6, nullptr, 10);
+        }
+    }
+#endif
+#if defined(__linux__) || defined(__APPLE__)
+    rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+#    if defined(__APPLE__)
+    return size_t(usage.ru_maxrss) / 1024; // byte
+#    else
+    return size_t(usage.ru_maxrss);
+#    endif
+#else
+    return 0;
+#endif
+}
+
+void WriteSummary(std::ostream& out, const char* name, Bench::Samples& samples) {
+    char text[256];
+    if(samples.empty()) {
+        std::snprintf(text, sizeof(text), "\"%s\": null", name);
+    }
+    else {
+        Bench::Result result = Bench::Summarize(samples);
+        std::snprintf(text, sizeof(text),
+            "\"%s\": { \"count\": %zu, \"mean\": %.2f, \"p50\": %.2f, \"p99\": %.2f, \"p999\": %.2f, \"max\": %.2f }", name,
+            result.samples, result.ns.mean, result.ns.p50, result.ns.p99, result.ns.p999, result.ns.max);
+    }
+    out << text;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    std::string lock  = "spin";
+    size_t      count = 64;
+    bool        ids   = false;
+    bool        pace  = false;
+    const char* path  = nullptr;
+
+    for(int i = 1; i < argc; ++i) {
+        const char* arg  = argv[i];
+        const char* next = i + 1 < argc ? argv[i + 1] : nullptr;
+
+        if(!std::strcmp(arg, "--lock") && next) {
+            lock = argv[++i];
+        }
+        else if(!std::strcmp(arg, "--count") && next) {
+            count = std::strtoull(argv[++i], nullptr, 10);
+        }
+        else if(!std::strcmp(arg, "--pace")) {
+            pace = true;
+        }
+        else if(!std::strcmp(arg, "--ops") && next) {
+            ids = !std::strcmp(argv[++i], "id");
+        }
+        else {
+            path = arg;
+        }
+    }
+
+    if(!path) {
+        std::fprintf(stderr, "usage: %s [--lock spin|ttas|ticket|mcs|futex|cache|lockfree|malloc] [--count 16|64|256] [--ops chunk|id] [--pace] trace\n", argv[0]);
+        return 1;
+    }
+
+    try {
+        Plan                     plan    = Prepare(Trace::Load(path), ids);
+        std::unique_ptr<Subject> subject = Create(lock, count);
+
+        size_t threads = plan.threads.size();
+        if(threads == 0) {
+            throw std::runtime_error("Empty trace.");
+        }
+
+        size_t ops     = 0;
+        for(const std::vector<Step>& steps : plan.threads) {
+            ops += steps.size();
+        }
+
+        std::unique_ptr<std::atomic<void*>[]> slots(new std::atomic<void*>[plan.sizes.size()]());
+        std::vector<Bench::Samples>           allocate(threads);
+        std::vector<Bench::Samples>           deallocate(threads);
+        std::vector<std::thread>              workers;
+        std::vector<Bench::Clock::time_point> begin(threads), end(threads);
+        Bench::Gate                           gate(threads);
+
+        ResetPeak();
+        size_t baseline = PeakRSS();
+
+        for(size_t t = 0; t < threads; ++t) {
+            workers.emplace_back([&, t] {
+                const std::vector<Step>& steps = plan.threads[t];
+                allocate[t].reserve(steps.size());
+                deallocate[t].reserve(steps.size());
+                gate.Wait();
+                begin[t] = Bench::Clock::now();
+
+                for(const Step& step : steps) {
+                    if(pace) {
+                        while(Bench::Clock::now() - begin[t] < std::chrono::nanoseconds(step.time)) {
+                            std::this_thread::yield();
+                        }
+                    }
+
+                    if(step.release) {
+                        // allocated by another thread, earlier in time
+                        void* ptr;
+                        while(!(ptr = slots[step.object].load(std::memory_order_acquire))) {
+                            std::this_thread::yield();
+                        }
+
+                        Bench::Clock::time_point since = Bench::Clock::now();
+                        subject->Deallocate(ptr, step.size);
+                        deallocate[t].push_back(Bench::Elapsed(since, 1));
+                        continue;
+                    }
+
+                    Bench::Clock::time_point since = Bench::Clock::now();
+                    void*                    ptr   = subject->Allocate(step.size);
+                    allocate[t].push_back(Bench::Elapsed(since, 1));
+
+                    std::memset(ptr, 0, step.size < 64 ? step.size : 64); // touch
+                    slots[step.object].store(ptr, std::memory_order_release);
+                }
+                end[t] = Bench::Clock::now();
+            });
+        }
+
+        for(std::thread& worker : workers) {
+            worker.join();
+        }
+
+        // first thread started to last thread finished
+        Bench::Clock::time_point first   = *std::min_element(begin.begin(), begin.end());
+        Bench::Clock::time_point last    = *std::max_element(end.begin(), end.end());
+        double                   seconds = std::chrono::duration<double>(last - first).count();
+        size_t peak    = PeakRSS();
+
+        // still live at the end of the trace
+        for(size_t i = 0; i < plan.sizes.size(); ++i) {
+            if(!plan.released[i]) {
+                subject->Deallocate(slots[i].load(std::memory_order_relaxed), plan.sizes[i]);
+            }
+        }
+
+        Bench::Samples allocated, deallocated;
+        for(size_t t = 0; t < threads; ++t) {
+            allocated.insert(allocated.end(), allocate[t].begin(), allocate[t].end());
+            deallocated.insert(deallocated.end(), deallocate[t].begin(), deallocate[t].end());
+        }
+
+        std::cout << "{\n";
+        std::cout << "    \"trace\": \"" << path << "\",\n";
+        std::cout << "    \"lock\": \"" << lock << "\",\n";
+        std::cout << "    \"count\": " << count << ",\n";
+        std::cout << "    \"ops\": \"" << (ids ? "id" : "chunk") << "\",\n";
+        std::cout << "    \"pace\": " << (pace ? "true" : "false") << ",\n";
+        std::cout << "    \"threads\": " << threads << ",\n";
+        std::cout << "    \"operations\": " << ops << ",\n";
+        std::cout << "    \"dropped\": " << plan.dropped << ",\n";
+        std::cout << "    \"seconds\": " << seconds << ",\n";
+        std::cout << "    \"throughput\": " << (seconds > 0 ? double(ops) / seconds : 0.0) << ",\n";
+        std::cout << "    \"ns\": {\n        ";
+        WriteSummary(std::cout, "allocate", allocated);
+        std::cout << ",\n        ";
+        WriteSummary(std::cout, "deallocate", deallocated);
+        std::cout << "\n    },\n";
+        std::cout << "    \"rss_kib\": { \"baseline\": " << baseline << ", \"peak\": " << peak << " }\n";
+        std::cout << "}\n";
+    }
+    catch(const std::exception& e) {
+        std::fprintf(stderr, "%s\n", e.what());
+        return 1;
+    }
+    return 0;
+}
@@ -1,11 +1,17 @@
 #ifndef LWE_UTILITES_BUFFER_HPP
 #define LWE_UTILITES_BUFFER_HPP
 
+#include <cstring>
+#include <memory>
+#include <span>
 #include <string>
+#include <string_view>
+#include <vector>
 
 #include "allocator.hpp"
 #include "config.h"
 #include "lock.hpp"
+#include "simd.hpp"
 
 /*
     Lock
@@ -15,6 +21,12 @@
     buffer like char[N]
     use memory pool
 
+    length
+    - Length(): used prefix, Size() / Capacity(): SIZE
+    - copy, assignment and std::string: used prefix only, by Simd kernels
+    - set by string / Assign / Append / Fill, terminated when room is left
+    - write through the pointer, then Resize()
+
     use
 
     Buffer<> arr = "string";
@@ -26,21 +38,52 @@
     Buffer<15, 8, 3, std::mutex> copy = arr; // size 16 byte, count 8, alignment 4
     std::string str = copy;
     std::cout << str;
+
+    Buffer<65536, SpinLock, 32, 8, HugeProvider<true>> large; // pool on 2 MiB pages
+    Packet recv{ Packet::Uninitialized() };                  // no memset, filled by recv()
+
+    Packet::Reserve(4096); // at startup, pages faulted in
+
+    size_t got = recv(socket, static_cast<char*>(recv), recv.Capacity(), 0);
+    recv.Resize(got);
+    size_t end = recv.Find("\r\n"); // Simd::NOT_FOUND: incomplete line
+
+    std::vector<Packet> burst = Packet::Create(64); // one lock per BURST
+    Packet::Release(burst);                         // one lock per BURST, buffers are moved-from state
  */
 
 template<size_t SIZE = EConfig::BUFFER_SIZE_DEFAULT, class Mtx = SpinLock,
     size_t POOL_CHUNK_COUNT = EConfig::MEMORY_ALLOCATE_DEFAULT,
-    size_t POOL_ALIGNMENT = EConfig::MEMORY_ALIGNMENT_DEFAULT
+    size_t POOL_ALIGNMENT = EConfig::MEMORY_ALIGNMENT_DEFAULT,
+    class Provider = HeapProvider
 >
 class Buffer {
 public:
-    using AllocatorType = Allocator<Block<SIZE>, Mtx, POOL_CHUNK_COUNT, POOL_ALIGNMENT>;
+    using AllocatorType = Allocator<Block<SIZE>, Mtx, POOL_CHUNK_COUNT, POOL_ALIGNMENT, Linked, Provider>;
 
 public:
-    static constexpr size_t Size();
+    struct Uninitialized {}; // tag, chunk is not zeroed
+
+public:
+    static constexpr size_t Size();     // SIZE
+    static constexpr size_t Capacity(); // SIZE
+
+public:
+    static std::vector<Buffer> Create(size_t); // bulk
+    static std::vector<Buffer> Create(size_t, Uninitialized);
+    static void                Release(std::span<Buffer>);
+    static size_t              Reserve(size_t, bool touch = true); // pre-warm N buffers, see Allocator::Reserve
+
+private:
+    static constexpr size_t BURST = 64; // stack array of Create / Release
+
+private:
+    struct Adopt {};
+    Buffer(Adopt, int8_t*); // allocated
 
 public:
     Buffer();
+    explicit Buffer(Uninitialized);
     Buffer(const Buffer&);
     Buffer(Buffer&&) noexcept;
     Buffer(const std::string&);
@@ -56,9 +99,28 @@ public:
     Buffer& operator=(const char*);
 
 public:
-    template<size_t, class, size_t, size_t> friend class Buffer;
-    template<size_t S, class L, size_t C, size_t A> Buffer(const Buffer<S, L, C, A>&);
-    template<size_t S, class L, size_t C, size_t A> Buffer& operator=(const Buffer<S, L, C, A>&);
+    template<size_t, class, size_t, size_t, class> friend class Buffer;
+    template<size_t S, class L, size_t C, size_t A, class P> Buffer(const Buffer<S, L, C, A, P>&);
+    template<size_t S, class L, size_t C, size_t A, class P> Buffer& operator=(const Buffer<S, L, C, A, P>&);
+
+public:
+    size_t Length() const;
+    size_t Resize(size_t);                 // clamped, bytes are not touched
+    size_t Assign(const void*, size_t);    // clamped, byte copied
+    size_t Append(const void*, size_t);    // clamped, byte copied
+    void   Fill(uint8_t, size_t = SIZE);   // clamped, length N
+    void   Clear();                        // length 0
+
+public:
+    std::string_view         View() const;
+    std::span<uint8_t>       Span();
+    std::span<const uint8_t> Span() const;
+
+public:
+    size_t Find(uint8_t, size_t offset = 0) const;          // Simd::NOT_FOUND
+    size_t Find(std::string_view, size_t offset = 0) const; // Simd::NOT_FOUND
+    bool   Equal(std::string_view) const;                   // other buffer: View()
+    int    Compare(std::string_view) const;                 // bytes, then length
 
 public:
     int8_t& operator[](size_t);
@@ -75,17 +137,18 @@ public:
     explicit operator char*() const;
     explicit operator int8_t*() const;
     explicit operator uint8_t*() const;
-    operator std::string() const;
+    operator std::string() const; // used prefix
 
 private:
     int8_t* ptr;
+    size_t  length = 0;
 
 private:
     static AllocatorType pool;
 };
 
-template<size_t SIZE, class Mtx, size_t COUNT, size_t ALIGN>
-Buffer<SIZE, Mtx, COUNT, ALIGN>::AllocatorType Buffer<SIZE, Mtx, COUNT, ALIGN>::pool;
+template<size_t SIZE, class Mtx, size_t COUNT, size_t ALIGN, class Provider>
+Buffer<SIZE, Mtx, COUNT, ALIGN, Provider>::AllocatorType Buffer<SIZE, Mtx, COUNT, ALIGN, Provider>::pool;
 
 using Packet = Buffer<EConfig::BUFFER_SIZE_DEFAULT>;
 
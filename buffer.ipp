@@ -1,116 +1,275 @@
 #ifdef LWE_UTILITES_BUFFER_HPP
 
-template<size_t SIZE, class Mtx, size_t COUNT, size_t ALIGN> Buffer<SIZE, Mtx, COUNT, ALIGN>::Buffer():
-    ptr(pool.Allocate<int8_t>()) {
+template<size_t SIZE, class Mtx, size_t COUNT, size_t ALIGN, class Provider> Buffer<SIZE, Mtx, COUNT, ALIGN, Provider>::Buffer():
+    ptr(pool.template Allocate<int8_t>()) {
     ::memset(ptr, 0, SIZE);
 }
 
-template<size_t SIZE, class Mtx, size_t COUNT, size_t ALIGN> Buffer<SIZE, Mtx, COUNT, ALIGN>::Buffer(const Buffer& ref): Buffer() {
-    memcpy(ptr, ref.ptr, SIZE);
+template<size_t SIZE, class Mtx, size_t COUNT, size_t ALIGN, class Provider> Buffer<SIZE, Mtx, COUNT, ALIGN, Provider>::Buffer(Uninitialized):
+    ptr(pool.template Allocate<int8_t>()) {}
+
+template<size_t SIZE, class Mtx, size_t COUNT, size_t ALIGN, class Provider> Buffer<SIZE, Mtx, COUNT, ALIGN, Provider>::Buffer(const Buffer& ref): Buffer(Uninitialized()) {
+    Assign(ref.ptr, ref.length);
+}
+
+template<size_t SIZE, class Mtx, size_t COUNT, size_t ALIGN, class Provider> Buffer<SIZE, Mtx, COUNT, ALIGN, Provider>::Buffer(Buffer&& ref) noexcept{
+    ptr        = ref.ptr; 
+    length     = ref.length;
+    ref.ptr    = nullptr;
+    ref.length = 0;
 }
 
-template<size_t SIZE, class Mtx, size_t COUNT, size_t ALIGN> Buffer<SIZE, Mtx, COUNT, ALIGN>::Buffer(Buffer&& ref) noexcept{
-    ptr     = ref.ptr; 
-    ref.ptr = nullptr;
+template<size_t SIZE, class Mtx, size_t COUNT, size_t ALIGN, class Provider> Buffer<SIZE, Mtx, COUNT, ALIGN, Provider>::Buffer(const std::string& str): Buffer(Uninitialized()) {
+    Assign(str.data(), str.size());
 }
 
-template<size_t SIZE, class Mtx, size_t COUNT, size_t ALIGN> Buffer<SIZE, Mtx, COUNT, ALIGN>::Buffer(const std::string& str): Buffer() {
-    memcpy(ptr, str.c_str(), SIZE < str.size() ? SIZE : str.size());
+template<size_t SIZE, class Mtx, size_t COUNT, size_t ALIGN, class Provider>
+Buffer<SIZE, Mtx, COUNT, ALIGN, Provider>::Buffer(const char* str): Buffer(Uninitialized()) {
+    Assign(str, Simd::Length(str, SIZE));
 }
 
-template<size_t SIZE, class Mtx, size_t COUNT, size_t ALIGN>
-Buffer<SIZE, Mtx, COUNT, ALIGN>::Buffer(const char* str): Buffer(std::string(str)) {}
+template<size_t SIZE, class Mtx, size_t COUNT, size_t ALIGN, class Provider>
+Buffer<SIZE, Mtx, COUNT, ALIGN, Provider>::Buffer(Adopt, int8_t* allocated): ptr(allocated) {}
 
-template<size_t SIZE, class Mtx, size_t COUNT, size_t ALIGN> Buffer<SIZE, Mtx, COUNT, ALIGN>::~Buffer() {
+template<size_t SIZE, class Mtx, size_t COUNT, size_t ALIGN, class Provider> Buffer<SIZE, Mtx, COUNT, ALIGN, Provider>::~Buffer() {
     pool.Deallocate(ptr);
 }
 
-template<size_t SIZE, class Mtx, size_t COUNT, size_t ALIGN>
-auto Buffer<SIZE, Mtx, COUNT, ALIGN>::operator=(const Buffer& ref) -> Buffer&{
-    memcpy(ptr, ref.ptr, SIZE);
+template<size_t SIZE, class Mtx, size_t COUNT, size_t ALIGN, class Provider>
+auto Buffer<SIZE, Mtx, COUNT, ALIGN, Provider>::operator=(const Buffer& ref) -> Buffer&{
+    if(this != std::addressof(ref)) {
+        Assign(ref.ptr, ref.length);
+    }
     return *this;
 }
 
-template<size_t SIZE, class Mtx, size_t COUNT, size_t ALIGN>
-auto Buffer<SIZE, Mtx, COUNT, ALIGN>::operator=(Buffer&& ref) noexcept -> Buffer& {
-    if(this != &ref) {
-        ptr     = ref.ptr;
-        ref.ptr = nullptr;
+template<size_t SIZE, class Mtx, size_t COUNT, size_t ALIGN, class Provider>
+auto Buffer<SIZE, Mtx, COUNT, ALIGN, Provider>::operator=(Buffer&& ref) noexcept -> Buffer& {
+    if(this != std::addressof(ref)) {
+        pool.Deallocate(ptr);
+        ptr        = ref.ptr;
+        length     = ref.length;
+        ref.ptr    = nullptr;
+        ref.length = 0;
     }
     return *this;
 }
 
-template<size_t SIZE, class Mtx, size_t COUNT, size_t ALIGN>
-auto Buffer<SIZE, Mtx, COUNT, ALIGN>::operator=(const std::string& str) -> Buffer& {
-    memcpy(ptr, str.c_str(), SIZE < str.size() ? SIZE : str.size());
+template<size_t SIZE, class Mtx, size_t COUNT, size_t ALIGN, class Provider>
+auto Buffer<SIZE, Mtx, COUNT, ALIGN, Provider>::operator=(const std::string& str) -> Buffer& {
+    Assign(str.data(), str.size());
     return *this;
 }
 
-template<size_t SIZE, class Mtx, size_t COUNT, size_t ALIGN>
-auto Buffer<SIZE, Mtx, COUNT, ALIGN>::operator=(const char* str) -> Buffer& {
-    std::string wrapper = str;
-    memcpy(ptr, wrapper.c_str(), SIZE < wrapper.size() ? SIZE : wrapper.size());
+template<size_t SIZE, class Mtx, size_t COUNT, size_t ALIGN, class Provider>
+auto Buffer<SIZE, Mtx, COUNT, ALIGN, Provider>::operator=(const char* str) -> Buffer& {
+    Assign(str, Simd::Length(str, SIZE));
     return *this;
 }
 
-template<size_t SIZE, class Mtx, size_t COUNT, size_t ALIGN>
-template<size_t N, class M, size_t CNT, size_t A>
-Buffer<SIZE, Mtx, COUNT, ALIGN>::Buffer(const Buffer<N, M, CNT, A>& other): Buffer() {
-    memcpy(ptr, other.ptr, SIZE < N ? SIZE : N);
+template<size_t SIZE, class Mtx, size_t COUNT, size_t ALIGN, class Provider>
+template<size_t N, class M, size_t CNT, size_t A, class P>
+Buffer<SIZE, Mtx, COUNT, ALIGN, Provider>::Buffer(const Buffer<N, M, CNT, A, P>& other): Buffer(Uninitialized()) {
+    Assign(other.ptr, other.length);
 }
 
-template<size_t SIZE, class Mtx, size_t COUNT, size_t ALIGN>
-template<size_t N, class M, size_t CNT, size_t A>
-auto Buffer<SIZE, Mtx, COUNT, ALIGN>::operator=(const Buffer<N, M, CNT, A>& other) -> Buffer& {
-    memcpy(ptr, other.ptr, SIZE < N ? SIZE : N);
+template<size_t SIZE, class Mtx, size_t COUNT, size_t ALIGN, class Provider>
+template<size_t N, class M, size_t CNT, size_t A, class P>
+auto Buffer<SIZE, Mtx, COUNT, ALIGN, Provider>::operator=(const Buffer<N, M, CNT, A, P>& other) -> Buffer& {
+    Assign(other.ptr, other.length);
     return *this;
 }
 
-template<size_t SIZE, class Mtx, size_t COUNT, size_t ALIGN> int8_t& Buffer<SIZE, Mtx, COUNT, ALIGN>::operator[](size_t i) {
+template<size_t SIZE, class Mtx, size_t COUNT, size_t ALIGN, class Provider> int8_t& Buffer<SIZE, Mtx, COUNT, ALIGN, Provider>::operator[](size_t i) {
     return ptr[i];
 }
 
-template<size_t SIZE, class Mtx, size_t COUNT, size_t ALIGN> int8_t Buffer<SIZE, Mtx, COUNT, ALIGN>::operator[](size_t i) const {
+template<size_t SIZE, class Mtx, size_t COUNT, size_t ALIGN, class Provider> int8_t Buffer<SIZE, Mtx, COUNT, ALIGN, Provider>::operator[](size_t i) const {
     return ptr[i];
 }
 
-template<size_t SIZE, class Mtx, size_t COUNT, size_t ALIGN> int8_t* Buffer<SIZE, Mtx, COUNT, ALIGN>::operator+(intptr_t i) const {
+template<size_t SIZE, class Mtx, size_t COUNT, size_t ALIGN, class Provider> int8_t* Buffer<SIZE, Mtx, COUNT, ALIGN, Provider>::operator+(intptr_t i) const {
     return ptr + i;
 }
 
-template<size_t SIZE, class Mtx, size_t COUNT, size_t ALIGN> int8_t* Buffer<SIZE, Mtx, COUNT, ALIGN>::operator-(intptr_t i) const {
+template<size_t SIZE, class Mtx, size_t COUNT, size_t ALIGN, class Provider> int8_t* Buffer<SIZE, Mtx, COUNT, ALIGN, Provider>::operator-(intptr_t i) const {
     return ptr - i;
 }
 
-template<size_t SIZE, class Mtx, size_t COUNT, size_t ALIGN> int8_t& Buffer<SIZE, Mtx, COUNT, ALIGN>::operator*() {
+template<size_t SIZE, class Mtx, size_t COUNT, size_t ALIGN, class Provider> int8_t& Buffer<SIZE, Mtx, COUNT, ALIGN, Provider>::operator*() {
     return *ptr;
 }
 
-template<size_t SIZE, class Mtx, size_t COUNT, size_t ALIGN> int8_t* Buffer<SIZE, Mtx, COUNT, ALIGN>::operator&() {
+template<size_t SIZE, class Mtx, size_t COUNT, size_t ALIGN, class Provider> int8_t* Buffer<SIZE, Mtx, COUNT, ALIGN, Provider>::operator&() {
     return ptr;
 }
 
-template<size_t SIZE, class Mtx, size_t COUNT, size_t ALIGN> Buffer<SIZE, Mtx, COUNT, ALIGN>::operator const char*() const {
+template<size_t SIZE, class Mtx, size_t COUNT, size_t ALIGN, class Provider> Buffer<SIZE, Mtx, COUNT, ALIGN, Provider>::operator const char*() const {
     return reinterpret_cast<const char*>(ptr);
 }
 
-template<size_t SIZE, class Mtx, size_t COUNT, size_t ALIGN> Buffer<SIZE, Mtx, COUNT, ALIGN>::operator char*() const {
+template<size_t SIZE, class Mtx, size_t COUNT, size_t ALIGN, class Provider> Buffer<SIZE, Mtx, COUNT, ALIGN, Provider>::operator char*() const {
     return reinterpret_cast<char*>(ptr);
 }
 
-template<size_t SIZE, class Mtx, size_t COUNT, size_t ALIGN> Buffer<SIZE, Mtx, COUNT, ALIGN>::operator int8_t*() const {
+template<size_t SIZE, class Mtx, size_t COUNT, size_t ALIGN, class Provider> Buffer<SIZE, Mtx, COUNT, ALIGN, Provider>::operator int8_t*() const {
     return ptr;
 }
 
-template<size_t SIZE, class Mtx, size_t COUNT, size_t ALIGN> Buffer<SIZE, Mtx, COUNT, ALIGN>::operator uint8_t*() const {
+template<size_t SIZE, class Mtx, size_t COUNT, size_t ALIGN, class Provider> Buffer<SIZE, Mtx, COUNT, ALIGN, Provider>::operator uint8_t*() const {
     return reinterpret_cast<uint8_t*>(ptr);
 }
 
-template<size_t SIZE, class Mtx, size_t COUNT, size_t ALIGN> Buffer<SIZE, Mtx, COUNT, ALIGN>::operator std::string() const {
-    return std::string(reinterpret_cast<char*>(ptr), SIZE);
+template<size_t SIZE, class Mtx, size_t COUNT, size_t ALIGN, class Provider> Buffer<SIZE, Mtx, COUNT, ALIGN, Provider>::operator std::string() const {
+    return std::string(reinterpret_cast<char*>(ptr), length);
+}
+
+template<size_t SIZE, class Mtx, size_t COUNT, size_t ALIGN, class Provider> constexpr size_t Buffer<SIZE, Mtx, COUNT, ALIGN, Provider>::Size() {
+    return SIZE;
 }
 
-template<size_t SIZE, class Mtx, size_t COUNT, size_t ALIGN> constexpr size_t Buffer<SIZE, Mtx, COUNT, ALIGN>::Size() {
+template<size_t SIZE, class Mtx, size_t COUNT, size_t ALIGN, class Provider>
+constexpr size_t Buffer<SIZE, Mtx, COUNT, ALIGN, Provider>::Capacity() {
     return SIZE;
 }
+
+template<size_t SIZE, class Mtx, size_t COUNT, size_t ALIGN, class Provider>
+size_t Buffer<SIZE, Mtx, COUNT, ALIGN, Provider>::Length() const {
+    return length;
+}
+
+template<size_t SIZE, class Mtx, size_t COUNT, size_t ALIGN, class Provider>
+size_t Buffer<SIZE, Mtx, COUNT, ALIGN, Provider>::Resize(size_t size) {
+    length = SIZE < size ? SIZE : size;
+    return length;
+}
+
+template<size_t SIZE, class Mtx, size_t COUNT, size_t ALIGN, class Provider>
+size_t Buffer<SIZE, Mtx, COUNT, ALIGN, Provider>::Assign(const void* data, size_t size) {
+    length = 0;
+    return Append(data, size);
+}
+
+template<size_t SIZE, class Mtx, size_t COUNT, size_t ALIGN, class Provider>
+size_t Buffer<SIZE, Mtx, COUNT, ALIGN, Provider>::Append(const void* data, size_t size) {
+    if(size > SIZE - length) size = SIZE - length;
+
+    Simd::Copy(ptr + length, data, size);
+    length += size;
+
+    // operator const char* stays a c string
+    if(length < SIZE) ptr[length] = 0;
+    return size;
+}
+
+template<size_t SIZE, class Mtx, size_t COUNT, size_t ALIGN, class Provider>
+void Buffer<SIZE, Mtx, COUNT, ALIGN, Provider>::Fill(uint8_t value, size_t size) {
+    length = SIZE < size ? SIZE : size;
+    Simd::Fill(ptr, value, length);
+}
+
+template<size_t SIZE, class Mtx, size_t COUNT, size_t ALIGN, class Provider>
+void Buffer<SIZE, Mtx, COUNT, ALIGN, Provider>::Clear() {
+    length = 0;
+    if(ptr) ptr[0] = 0;
+}
+
+template<size_t SIZE, class Mtx, size_t COUNT, size_t ALIGN, class Provider>
+std::string_view Buffer<SIZE, Mtx, COUNT, ALIGN, Provider>::View() const {
+    return std::string_view(reinterpret_cast<const char*>(ptr), length);
+}
+
+template<size_t SIZE, class Mtx, size_t COUNT, size_t ALIGN, class Provider>
+std::span<uint8_t> Buffer<SIZE, Mtx, COUNT, ALIGN, Provider>::Span() {
+    return std::span<uint8_t>(reinterpret_cast<uint8_t*>(ptr), length);
+}
+
+template<size_t SIZE, class Mtx, size_t COUNT, size_t ALIGN, class Provider>
+std::span<const uint8_t> Buffer<SIZE, Mtx, COUNT, ALIGN, Provider>::Span() const {
+    return std::span<const uint8_t>(reinterpret_cast<const uint8_t*>(ptr), length);
+}
+
+template<size_t SIZE, class Mtx, size_t COUNT, size_t ALIGN, class Provider>
+size_t Buffer<SIZE, Mtx, COUNT, ALIGN, Provider>::Find(uint8_t value, size_t offset) const {
+    if(offset >= length) {
+        return Simd::NOT_FOUND;
+    }
+
+    size_t at = Simd::Find(ptr + offset, length - offset, value);
+    return at == Simd::NOT_FOUND ? at : offset + at;
+}
+
+template<size_t SIZE, class Mtx, size_t COUNT, size_t ALIGN, class Provider>
+size_t Buffer<SIZE, Mtx, COUNT, ALIGN, Provider>::Find(std::string_view pattern, size_t offset) const {
+    if(offset > length) {
+        return Simd::NOT_FOUND;
+    }
+
+    size_t at = Simd::Find(ptr + offset, length - offset, pattern.data(), pattern.size());
+    return at == Simd::NOT_FOUND ? at : offset + at;
+}
+
+template<size_t SIZE, class Mtx, size_t COUNT, size_t ALIGN, class Provider>
+bool Buffer<SIZE, Mtx, COUNT, ALIGN, Provider>::Equal(std::string_view other) const {
+    return length == other.size() && Simd::Equal(ptr, other.data(), length);
+}
+
+template<size_t SIZE, class Mtx, size_t COUNT, size_t ALIGN, class Provider>
+int Buffer<SIZE, Mtx, COUNT, ALIGN, Provider>::Compare(std::string_view other) const {
+    int result = Simd::Compare(ptr, other.data(), length < other.size() ? length : other.size());
+    if(result != 0) {
+        return result;
+    }
+    return length < other.size() ? -1 : (length > other.size() ? 1 : 0);
+}
+
+template<size_t SIZE, class Mtx, size_t COUNT, size_t ALIGN, class Provider>
+auto Buffer<SIZE, Mtx, COUNT, ALIGN, Provider>::Create(size_t count) -> std::vector<Buffer> {
+    std::vector<Buffer> buffers = Create(count, Uninitialized());
+    for(Buffer& buffer : buffers) {
+        ::memset(buffer.ptr, 0, SIZE);
+    }
+    return buffers;
+}
+
+template<size_t SIZE, class Mtx, size_t COUNT, size_t ALIGN, class Provider>
+auto Buffer<SIZE, Mtx, COUNT, ALIGN, Provider>::Create(size_t count, Uninitialized) -> std::vector<Buffer> {
+    std::vector<Buffer> buffers;
+    buffers.reserve(count);
+
+    int8_t* ptrs[BURST];
+    while(buffers.size() < count) {
+        size_t want = count - buffers.size() < BURST ? count - buffers.size() : BURST;
+        size_t got  = pool.AllocateBatch(want, ptrs);
+
+        for(size_t i = 0; i < got; ++i) {
+            buffers.push_back(Buffer(Adopt(), ptrs[i]));
+        }
+        if(got < want) {
+            break; // out of memory, what was allocated
+        }
+    }
+    return buffers;
+}
+
+template<size_t SIZE, class Mtx, size_t COUNT, size_t ALIGN, class Provider>
+void Buffer<SIZE, Mtx, COUNT, ALIGN, Provider>::Release(std::span<Buffer> buffers) {
+    int8_t* ptrs[BURST];
+    for(size_t begin = 0; begin < buffers.size(); begin += BURST) {
+        size_t count = buffers.size() - begin < BURST ? buffers.size() - begin : BURST;
+
+        for(size_t i = 0; i < count; ++i) {
+            Buffer& buffer = buffers[begin + i];
+            ptrs[i]        = buffer.ptr;
+            buffer.ptr     = nullptr;
+            buffer.length  = 0;
+        }
+        pool.template DeallocateBatch<int8_t>({ ptrs, count });
+    }
+}
+
+template<size_t SIZE, class Mtx, size_t COUNT, size_t ALIGN, class Provider>
+size_t Buffer<SIZE, Mtx, COUNT, ALIGN, Provider>::Reserve(size_t count, bool touch) {
+    return pool.Reserve(count, touch);
+}
 #endif
\ No newline at end of file
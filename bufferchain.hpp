@@ -0,0 +1,94 @@
+#ifndef LWE_UTILITIES_BUFFERCHAIN_HPP
+#define LWE_UTILITIES_BUFFERCHAIN_HPP
+
+#include <deque>
+#include <vector>
+
+#ifndef _WIN32
+#    include <sys/uio.h>
+#endif
+
+#include "sharedbuffer.hpp"
+
+/*
+    scatter gather chain of pooled chunks
+    - segments are SharedBuffer views, a message is not limited to SIZE
+    - Append / Prepend of a view: no byte copied
+    - Append / Prepend of bytes: copied once into the room of the tail / head chunk, then new chunks
+      a prepended chunk is filled from its end, the next header goes in front of it
+    - Consume / Split: views are cut, chunk shared by both sides when split inside it
+    - Export: one IoVec per segment for writev / sendmsg
+    - Prepare / Commit: room for readv / recvmsg, then the bytes read become the tail
+    - IoVec: iovec, Windows: WSABUF layout, pass as LPWSABUF to WSASend / WSARecv
+
+    use
+
+    BufferChain<> out;
+    out.Append(payload);                      // SharedPacket, no copy
+    out.Prepend(&header, sizeof(header));     // in front, no payload copy
+
+    BufferChain<>::IoVec io[16];
+    ssize_t sent = writev(socket, io, int(out.Export(io, 16)));
+    out.Consume(sent > 0 ? size_t(sent) : 0); // partial write kept
+
+    BufferChain<> in;
+    ssize_t got = readv(socket, io, int(in.Prepare(65536, io, 16)));
+    in.Commit(got > 0 ? size_t(got) : 0);     // -1: error, nothing read
+
+    BufferChain<> frame = in.Split(length);   // first message, rest stays in `in`
+*/
+template<size_t SIZE = EConfig::BUFFER_SIZE_DEFAULT, class Mtx = SpinLock,
+    size_t POOL_CHUNK_COUNT = EConfig::MEMORY_ALLOCATE_DEFAULT,
+    size_t POOL_ALIGNMENT = EConfig::MEMORY_ALIGNMENT_DEFAULT,
+    class Provider = HeapProvider
+>
+class BufferChain {
+public:
+    using Segment = SharedBuffer<SIZE, Mtx, POOL_CHUNK_COUNT, POOL_ALIGNMENT, Provider>;
+
+#ifdef _WIN32
+    struct IoVec {
+        unsigned long len; // WSABUF, no winsock include here
+        char*         buf;
+    };
+#else
+    using IoVec = iovec;
+#endif
+
+public:
+    size_t Append(const Segment&); // byte appended
+    size_t Append(const void*, size_t);
+    size_t Prepend(const Segment&);
+    size_t Prepend(const void*, size_t);
+    void   Append(BufferChain&&); // segments moved
+
+public:
+    size_t      Consume(size_t);                              // from front, byte dropped
+    BufferChain Split(size_t);                                // first N byte moved out
+    size_t      Copy(void*, size_t, size_t offset = 0) const; // gather, byte copied
+    void        Clear();
+
+public:
+    size_t Export(IoVec*, size_t count, size_t offset = 0) const; // IoVec filled, from offset
+    size_t Prepare(size_t, IoVec*, size_t count);                 // IoVec filled, room of N byte at most
+    size_t Commit(size_t);                                        // byte read, capped to the room offered
+
+public:
+    size_t                     Size() const;  // byte
+    size_t                     Count() const; // segment
+    bool                       Empty() const;
+    const std::deque<Segment>& Segments() const;
+
+private:
+    static size_t Room(const Segment&);       // free byte after the view, 0: shared
+    static void   Set(IoVec&, void*, size_t); // platform fields
+
+private:
+    std::deque<Segment>  segments;
+    std::vector<Segment> prepared; // Prepare, not committed
+    size_t               tail = 0; // room of the last segment in Prepare
+    size_t               size = 0;
+};
+
+#include "bufferchain.ipp"
+#endif
@@ -0,0 +1,306 @@
+#include "bufferchain.hpp"
+
+#ifdef LWE_UTILITIES_BUFFERCHAIN_HPP
+
+template<size_t SIZE, class Mtx, size_t COUNT, size_t ALIGN, class Provider>
+size_t BufferChain<SIZE, Mtx, COUNT, ALIGN, Provider>::Append(const Segment& segment) {
+    if(segment.Size() == 0) {
+        return 0;
+    }
+
+    segments.push_back(segment);
+    size += segment.Size();
+    return segment.Size();
+}
+
+template<size_t SIZE, class Mtx, size_t COUNT, size_t ALIGN, class Provider>
+size_t BufferChain<SIZE, Mtx, COUNT, ALIGN, Provider>::Append(const void* data, size_t length) {
+    const uint8_t* source = static_cast<const uint8_t*>(data);
+    size_t         done   = 0;
+
+    // room after the tail view
+    if(!segments.empty()) {
+        Segment& last = segments.back();
+
+        done = Room(last) < length ? Room(last) : length;
+        ::memcpy(last.chunk->data + last.offset + last.length, source, done);
+        last.length += done;
+    }
+
+    while(done < length) {
+        Segment segment{ typename Segment::Uninitialized() };
+        if(!segment.chunk) {
+            break;
+        }
+
+        segment.length = SIZE < length - done ? SIZE : length - done;
+        ::memcpy(segment.chunk->data, source + done, segment.length);
+        done += segment.length;
+        segments.push_back(std::move(segment));
+    }
+
+    size += done;
+    return done;
+}
+
+template<size_t SIZE, class Mtx, size_t COUNT, size_t ALIGN, class Provider>
+size_t BufferChain<SIZE, Mtx, COUNT, ALIGN, Provider>::Prepend(const Segment& segment) {
+    if(segment.Size() == 0) {
+        return 0;
+    }
+
+    segments.push_front(segment);
+    size += segment.Size();
+    return segment.Size();
+}
+
+template<size_t SIZE, class Mtx, size_t COUNT, size_t ALIGN, class Provider>
+size_t BufferChain<SIZE, Mtx, COUNT, ALIGN, Provider>::Prepend(const void* data, size_t length) {
+    const uint8_t* source = static_cast<const uint8_t*>(data);
+    size_t         done   = 0; // from the end of source
+
+    // room before the head view
+    if(!segments.empty() && segments.front().Unique()) {
+        Segment& first = segments.front();
+
+        done = first.offset < length ? first.offset : length;
+        first.offset -= done;
+        first.length += done;
+        ::memcpy(first.chunk->data + first.offset, source + length - done, done);
+    }
+
+    // filled from the end, room left for the next header
+    while(done < length) {
+        Segment segment{ typename Segment::Uninitialized() };
+        if(!segment.chunk) {
+            break;
+        }
+
+        segment.length = SIZE < length - done ? SIZE : length - done;
+        segment.offset = SIZE - segment.length;
+        done += segment.length;
+        ::memcpy(segment.chunk->data + segment.offset, source + length - done, segment.length);
+        segments.push_front(std::move(segment));
+    }
+
+    size += done;
+    return done;
+}
+
+template<size_t SIZE, class Mtx, size_t COUNT, size_t ALIGN, class Provider>
+void BufferChain<SIZE, Mtx, COUNT, ALIGN, Provider>::Append(BufferChain&& other) {
+    if(this == &other) {
+        return;
+    }
+
+    for(Segment& segment : other.segments) {
+        segments.push_back(std::move(segment));
+    }
+    size += other.size;
+    other.Clear();
+}
+
+template<size_t SIZE, class Mtx, size_t COUNT, size_t ALIGN, class Provider>
+size_t BufferChain<SIZE, Mtx, COUNT, ALIGN, Provider>::Consume(size_t length) {
+    size_t done = 0;
+
+    while(done < length && !segments.empty()) {
+        Segment& first = segments.front();
+        size_t   cut   = first.length < length - done ? first.length : length - done;
+
+        if(cut == first.length) {
+            segments.pop_front();
+        }
+        else {
+            first.offset += cut;
+            first.length -= cut;
+        }
+        done += cut;
+    }
+
+    size -= done;
+    return done;
+}
+
+template<size_t SIZE, class Mtx, size_t COUNT, size_t ALIGN, class Provider>
+auto BufferChain<SIZE, Mtx, COUNT, ALIGN, Provider>::Split(size_t length) -> BufferChain {
+    BufferChain front;
+
+    while(front.size < length && !segments.empty()) {
+        Segment& first = segments.front();
+        size_t   cut   = first.length < length - front.size ? first.length : length - front.size;
+
+        // inside a segment: both sides share the chunk
+        if(cut == first.length) {
+            front.segments.push_back(std::move(first));
+            segments.pop_front();
+        }
+        else {
+            front.segments.push_back(first.Slice(0, cut));
+            first.offset += cut;
+            first.length -= cut;
+        }
+        front.size += cut;
+    }
+
+    size -= front.size;
+    return front;
+}
+
+template<size_t SIZE, class Mtx, size_t COUNT, size_t ALIGN, class Provider>
+size_t BufferChain<SIZE, Mtx, COUNT, ALIGN, Provider>::Copy(void* data, size_t length, size_t offset) const {
+    uint8_t* target = static_cast<uint8_t*>(data);
+    size_t   done   = 0;
+
+    for(const Segment& segment : segments) {
+        if(done == length) {
+            break;
+        }
+        if(offset >= segment.length) {
+            offset -= segment.length;
+            continue;
+        }
+
+        size_t copy = segment.length - offset < length - done ? segment.length - offset : length - done;
+        ::memcpy(target + done, segment.Data() + offset, copy);
+        done  += copy;
+        offset = 0;
+    }
+    return done;
+}
+
+template<size_t SIZE, class Mtx, size_t COUNT, size_t ALIGN, class Provider>
+void BufferChain<SIZE, Mtx, COUNT, ALIGN, Provider>::Clear() {
+    segments.clear();
+    prepared.clear();
+    tail = 0;
+    size = 0;
+}
+
+template<size_t SIZE, class Mtx, size_t COUNT, size_t ALIGN, class Provider>
+size_t BufferChain<SIZE, Mtx, COUNT, ALIGN, Provider>::Export(IoVec* io, size_t count, size_t offset) const {
+    size_t filled = 0;
+
+    for(const Segment& segment : segments) {
+        if(filled == count) {
+            break;
+        }
+        if(offset >= segment.length) {
+            offset -= segment.length;
+            continue;
+        }
+
+        Set(io[filled], const_cast<uint8_t*>(segment.Data() + offset), segment.length - offset);
+        ++filled;
+        offset = 0;
+    }
+    return filled;
+}
+
+template<size_t SIZE, class Mtx, size_t COUNT, size_t ALIGN, class Provider>
+size_t BufferChain<SIZE, Mtx, COUNT, ALIGN, Provider>::Prepare(size_t length, IoVec* io, size_t count) {
+    size_t filled = 0;
+    size_t room   = 0;
+
+    prepared.clear();
+    tail = 0;
+
+    if(count == 0) {
+        return 0;
+    }
+
+    // room after the tail view first
+    if(!segments.empty()) {
+        Segment& last = segments.back();
+
+        tail = Room(last) < length ? Room(last) : length;
+        if(tail) {
+            Set(io[filled], last.chunk->data + last.offset + last.length, tail);
+            ++filled;
+            room = tail;
+        }
+    }
+
+    while(room < length && filled < count) {
+        Segment segment{ typename Segment::Uninitialized() };
+        if(!segment.chunk) {
+            break;
+        }
+
+        size_t bytes = SIZE < length - room ? SIZE : length - room;
+        Set(io[filled], segment.chunk->data, bytes);
+        room += bytes;
+        ++filled;
+
+        segment.length = bytes; // room offered, cut to what was read in Commit
+        prepared.push_back(std::move(segment));
+    }
+    return filled;
+}
+
+template<size_t SIZE, class Mtx, size_t COUNT, size_t ALIGN, class Provider>
+size_t BufferChain<SIZE, Mtx, COUNT, ALIGN, Provider>::Commit(size_t length) {
+    size_t done = tail < length ? tail : length;
+    if(done) {
+        segments.back().length += done;
+    }
+
+    // unused room goes back to the pool
+    for(Segment& segment : prepared) {
+        if(done == length) {
+            break;
+        }
+
+        // never more than Prepare offered in this segment's IoVec
+        segment.length = segment.length < length - done ? segment.length : length - done;
+        done += segment.length;
+        segments.push_back(std::move(segment));
+    }
+
+    prepared.clear();
+    tail  = 0;
+    size += done;
+    return done;
+}
+
+template<size_t SIZE, class Mtx, size_t COUNT, size_t ALIGN, class Provider>
+size_t BufferChain<SIZE, Mtx, COUNT, ALIGN, Provider>::Size() const {
+    return size;
+}
+
+template<size_t SIZE, class Mtx, size_t COUNT, size_t ALIGN, class Provider>
+size_t BufferChain<SIZE, Mtx, COUNT, ALIGN, Provider>::Count() const {
+    return segments.size();
+}
+
+template<size_t SIZE, class Mtx, size_t COUNT, size_t ALIGN, class Provider>
+bool BufferChain<SIZE, Mtx, COUNT, ALIGN, Provider>::Empty() const {
+    return size == 0;
+}
+
+template<size_t SIZE, class Mtx, size_t COUNT, size_t ALIGN, class Provider>
+auto BufferChain<SIZE, Mtx, COUNT, ALIGN, Provider>::Segments() const -> const std::deque<Segment>& {
+    return segments;
+}
+
+template<size_t SIZE, class Mtx, size_t COUNT, size_t ALIGN, class Provider>
+size_t BufferChain<SIZE, Mtx, COUNT, ALIGN, Provider>::Room(const Segment& segment) {
+    // another view of the chunk may cover the bytes after this one
+    if(!segment.Unique()) {
+        return 0;
+    }
+    return SIZE - segment.offset - segment.length;
+}
+
+template<size_t SIZE, class Mtx, size_t COUNT, size_t ALIGN, class Provider>
+void BufferChain<SIZE, Mtx, COUNT, ALIGN, Provider>::Set(IoVec& io, void* data, size_t length) {
+#ifdef _WIN32
+    io.buf = static_cast<char*>(data);
+    io.len = static_cast<unsigned long>(length); // SIZE per segment, fits
+#else
+    io.iov_base = data;
+    io.iov_len  = length;
+#endif
+}
+
+#endif
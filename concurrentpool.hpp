@@ -0,0 +1,122 @@
+#ifndef LWE_UTILITIES_CONCURRENTPOOL_HPP
+#define LWE_UTILITIES_CONCURRENTPOOL_HPP
+
+#include <atomic>
+#include <bit>
+#include <vector>
+
+#include "allocator.hpp"
+#include "epoch.hpp"
+#include "id.hpp"
+#include "trace.hpp"
+
+/*
+    thread safe Pool, readers take no lock
+    - Find / Exist / ForEach: no lock, pin an Epoch; Find needs the caller's Epoch::Guard
+    - Insert / Erase: shard lock, Insert on the shard of this thread, Erase on the shard of the ID
+    - erased instance is retired, destroyed once no pinned reader can hold it
+
+    storage
+    - segments of SEGMENT, SEGMENT, 2 * SEGMENT, 4 * SEGMENT ..., never moved, Item* stays valid
+    - ID index: shard local index * SHARDS + shard, generation of the shard's ID::Manager
+    - readers may share an instance, T is read only to them or synchronized by T itself
+
+    use
+
+    ConcurrentPool<Entity> entities;
+
+    ID id = entities.Insert(Entity{ ... }); // any thread
+
+    {
+        Epoch::Guard guard;
+        Entity* entity = entities.Find(id); // valid until guard ends
+    }
+    entities.Read(id, [](const Entity& entity) { ... }); // pinned inside
+
+    entities.Erase(id); // any thread
+*/
+template<typename T, class Mtx = SpinLock,
+    size_t SHARDS           = EConfig::POOL_SHARD_DEFAULT,
+    size_t POOL_CHUNK_COUNT = EConfig::MEMORY_ALLOCATE_DEFAULT,
+    size_t POOL_ALIGNMENT   = EConfig::MEMORY_ALIGNMENT_DEFAULT>
+class ConcurrentPool {
+public:
+    NO_COPYABLE(ConcurrentPool);
+    NO_MOVABLE(ConcurrentPool);
+
+private:
+    struct Allocate {
+        T _;
+    };
+
+public:
+    using Allocator = ::Allocator<Allocate, void, POOL_CHUNK_COUNT, POOL_ALIGNMENT>; // shard lock
+    using LockType  = Lock<Mtx>::Type;
+
+    static_assert(SHARDS > 0, "Shard count must be positive.");
+
+private:
+    static constexpr size_t SEGMENT  = EConfig::POOL_SEGMENT_DEFAULT;
+    static constexpr size_t SEGMENTS = std::bit_width(ID::INDEX_MASK / SEGMENT) + 1;
+    static constexpr size_t RECLAIM  = EConfig::POOL_RECLAIM_DEFAULT;
+
+    static_assert(std::has_single_bit(SEGMENT), "Segment size must be a power of two.");
+
+private:
+    struct Item {
+        std::atomic<ID::Value> id       = ECode::INVALID_ID; // published last
+        std::atomic<T*>        instance = nullptr;
+    };
+
+    struct Retired {
+        T*       instance;
+        uint64_t epoch;
+    };
+
+    struct alignas(EConfig::MEMORY_CACHE_LINE_DEFAULT) Shard {
+        LockType             mtx;
+        ID::Manager          ids;
+        Allocator            allocator;
+        std::vector<Retired> retired;
+    };
+
+public:
+    ConcurrentPool() = default;
+    ~ConcurrentPool();
+
+public:
+    template<typename Arg> ID Insert(Arg&&); // invalid: full
+    bool                      Erase(ID);
+    void                      Clear();       // erase all
+
+public:
+    T*                        Find(ID);      // caller holds an Epoch::Guard
+    bool                      Exist(ID);
+    template<typename F> bool Read(ID, F&&); // f(T&) pinned, false: not found
+    template<typename F> void ForEach(F&&);  // f(ID, T&) pinned, no order
+    size_t                    Size() const;
+    size_t                    Reclaim();     // destroy retired, all shards
+
+private:
+    Item*  Locate(size_t index) const; // null: segment not allocated
+    Item&  Reserve(size_t index);      // allocate segment on demand
+    size_t Index() const;              // shard of this thread
+    void   Release(Shard&, Item&, ID); // shard locked, retire instance
+    size_t Reclaim(Shard&);            // shard locked
+
+private:
+    static size_t Segment(size_t index); // segment of index
+    static size_t Base(size_t segment);  // first index of segment
+
+private:
+    Shard               shards[SHARDS];
+    std::atomic<Item*>  segments[SEGMENTS] = {};
+    std::atomic<size_t> count              = 0;
+    std::atomic<size_t> high               = 0; // highest index + 1 ever used
+
+private:
+    static std::atomic<size_t> sequence; // next thread index
+};
+
+#include "concurrentpool.ipp"
+#endif
@@ -0,0 +1,281 @@
+#include "concurrentpool.hpp"
+
+#ifdef LWE_UTILITIES_CONCURRENTPOOL_HPP
+
+template<typename T, class Mtx, size_t S, size_t N, size_t A>
+std::atomic<size_t> ConcurrentPool<T, Mtx, S, N, A>::sequence = 0;
+
+template<typename T, class Mtx, size_t S, size_t N, size_t A>
+ConcurrentPool<T, Mtx, S, N, A>::~ConcurrentPool() {
+    for(size_t i = 0; i < SEGMENTS; ++i) {
+        Item* segment = segments[i].load(std::memory_order_relaxed);
+        if(!segment) continue;
+
+        size_t base = Base(i);
+        size_t size = i == 0 ? SEGMENT : base;
+        for(size_t j = 0; j < size; ++j) {
+            if(segment[j].id.load(std::memory_order_relaxed) != ECode::INVALID_ID) {
+                T* instance = segment[j].instance.load(std::memory_order_relaxed);
+                instance->~T();
+                shards[(base + j) % S].allocator.Deallocate(instance);
+            }
+        }
+        delete[] segment;
+    }
+
+    // no reader is left
+    for(Shard& shard : shards) {
+        for(Retired& retired : shard.retired) {
+            retired.instance->~T();
+            shard.allocator.Deallocate(retired.instance);
+        }
+    }
+}
+
+template<typename T, class Mtx, size_t S, size_t N, size_t A>
+template<typename Arg>
+ID ConcurrentPool<T, Mtx, S, N, A>::Insert(Arg&& arg) {
+    size_t shard = Index();
+    Shard& local = shards[shard];
+
+    [[maybe_unused]] LockGuard _(local.mtx);
+
+    ID next = local.ids.Generate();
+    if(next == ECode::INVALID_ID) {
+        return ID::Invalid(); // exhausted
+    }
+
+    size_t index = next.Index() * S + shard;
+    if(index > ID::INDEX_MASK) {
+        local.ids.Release(next);
+        return ID::Invalid();
+    }
+
+    // slot first, a segment that fails to grow leaves nothing behind
+    Item* item;
+    try {
+        item = &Reserve(index);
+    }
+    catch(...) {
+        local.ids.Release(next);
+        throw;
+    }
+
+    T* instance = local.allocator.template Allocate<T>();
+    if(!instance) {
+        local.ids.Release(next);
+        return ID::Invalid(); // failed call malloc()
+    }
+
+    try {
+        new(instance) T(std::forward<Arg>(arg));
+    }
+    catch(...) {
+        local.allocator.Deallocate(instance);
+        local.ids.Release(next);
+        throw;
+    }
+
+    ID id = ID::Make(index, next.Generation());
+    item->instance.store(instance, std::memory_order_release);
+    item->id.store(id, std::memory_order_release); // published
+
+    count.fetch_add(1, std::memory_order_relaxed);
+    for(size_t last = high.load(std::memory_order_relaxed);
+        last <= index && !high.compare_exchange_weak(last, index + 1, std::memory_order_release);) {}
+
+    Trace::Write(Trace::INSERT, id, sizeof(T));
+    return id;
+}
+
+template<typename T, class Mtx, size_t S, size_t N, size_t A>
+bool ConcurrentPool<T, Mtx, S, N, A>::Erase(ID id) {
+    size_t index = id.Index();
+    if(index < S) {
+        return false; // local index 0
+    }
+
+    Shard& shard = shards[index % S];
+
+    [[maybe_unused]] LockGuard _(shard.mtx);
+
+    Item* item = Locate(index);
+    if(!item || item->id.load(std::memory_order_relaxed) != id) {
+        return false;
+    }
+
+    Trace::Write(Trace::ERASE, id, sizeof(T));
+    Release(shard, *item, id);
+    return true;
+}
+
+template<typename T, class Mtx, size_t S, size_t N, size_t A>
+void ConcurrentPool<T, Mtx, S, N, A>::Clear() {
+    for(size_t i = 0; i < S; ++i) {
+        Shard& shard = shards[i];
+
+        [[maybe_unused]] LockGuard _(shard.mtx);
+
+        size_t last = high.load(std::memory_order_acquire);
+        for(size_t index = S + i; index < last; index += S) {
+            Item* item = Locate(index);
+            if(!item) continue;
+
+            ID id(item->id.load(std::memory_order_relaxed));
+            if(id != ECode::INVALID_ID) {
+                Trace::Write(Trace::ERASE, id, sizeof(T));
+                Release(shard, *item, id);
+            }
+        }
+    }
+}
+
+template<typename T, class Mtx, size_t S, size_t N, size_t A>
+T* ConcurrentPool<T, Mtx, S, N, A>::Find(ID id) {
+    if(id == ECode::INVALID_ID) {
+        return nullptr;
+    }
+
+    Item* item = Locate(id.Index());
+    if(!item || item->id.load(std::memory_order_seq_cst) != id) { // after the pin
+        return nullptr;
+    }
+
+    // slot erased and reused in between: instance of the new ID, id no longer matches
+    T* instance = item->instance.load(std::memory_order_acquire);
+    if(item->id.load(std::memory_order_acquire) != id) {
+        return nullptr;
+    }
+    return instance;
+}
+
+template<typename T, class Mtx, size_t S, size_t N, size_t A>
+bool ConcurrentPool<T, Mtx, S, N, A>::Exist(ID id) {
+    Epoch::Guard guard;
+    return Find(id) != nullptr;
+}
+
+template<typename T, class Mtx, size_t S, size_t N, size_t A>
+template<typename F>
+bool ConcurrentPool<T, Mtx, S, N, A>::Read(ID id, F&& f) {
+    Epoch::Guard guard;
+
+    T* instance = Find(id);
+    if(!instance) {
+        return false;
+    }
+    f(*instance);
+    return true;
+}
+
+template<typename T, class Mtx, size_t S, size_t N, size_t A>
+template<typename F>
+void ConcurrentPool<T, Mtx, S, N, A>::ForEach(F&& f) {
+    Epoch::Guard guard;
+
+    size_t last = high.load(std::memory_order_acquire);
+    for(size_t index = S; index < last; ++index) {
+        Item* item = Locate(index);
+        if(!item) {
+            index = Base(Segment(index) + 1) - 1; // segment not allocated
+            continue;
+        }
+
+        ID id(item->id.load(std::memory_order_seq_cst));
+        if(id == ECode::INVALID_ID) continue;
+
+        T* instance = item->instance.load(std::memory_order_acquire);
+        if(item->id.load(std::memory_order_acquire) == id) {
+            f(id, *instance);
+        }
+    }
+}
+
+template<typename T, class Mtx, size_t S, size_t N, size_t A>
+size_t ConcurrentPool<T, Mtx, S, N, A>::Size() const {
+    return count.load(std::memory_order_relaxed);
+}
+
+template<typename T, class Mtx, size_t S, size_t N, size_t A>
+size_t ConcurrentPool<T, Mtx, S, N, A>::Reclaim() {
+    size_t reclaimed = 0;
+    for(Shard& shard : shards) {
+        [[maybe_unused]] LockGuard _(shard.mtx);
+        reclaimed += Reclaim(shard);
+    }
+    return reclaimed;
+}
+
+template<typename T, class Mtx, size_t S, size_t N, size_t A>
+auto ConcurrentPool<T, Mtx, S, N, A>::Locate(size_t index) const -> Item* {
+    size_t segment = Segment(index);
+    if(segment >= SEGMENTS) {
+        return nullptr;
+    }
+
+    Item* items = segments[segment].load(std::memory_order_acquire);
+    return items ? items + (index - Base(segment)) : nullptr;
+}
+
+template<typename T, class Mtx, size_t S, size_t N, size_t A>
+auto ConcurrentPool<T, Mtx, S, N, A>::Reserve(size_t index) -> Item& {
+    size_t segment = Segment(index);
+    Item*  items   = segments[segment].load(std::memory_order_acquire);
+
+    if(!items) {
+        // shards grow the same segment, first one wins
+        Item* allocated = new Item[segment == 0 ? SEGMENT : Base(segment)];
+        if(segments[segment].compare_exchange_strong(items, allocated, std::memory_order_acq_rel)) {
+            items = allocated;
+        }
+        else delete[] allocated;
+    }
+    return items[index - Base(segment)];
+}
+
+template<typename T, class Mtx, size_t S, size_t N, size_t A>
+size_t ConcurrentPool<T, Mtx, S, N, A>::Index() const {
+    static thread_local size_t slot = sequence.fetch_add(1, std::memory_order_relaxed);
+    return slot % S;
+}
+
+template<typename T, class Mtx, size_t S, size_t N, size_t A>
+void ConcurrentPool<T, Mtx, S, N, A>::Release(Shard& shard, Item& item, ID id) {
+    T* instance = item.instance.load(std::memory_order_relaxed);
+    item.id.store(ECode::INVALID_ID, std::memory_order_seq_cst); // unlinked before the epoch is read
+
+    shard.ids.Release(ID::Make(id.Index() / S, id.Generation()));
+    count.fetch_sub(1, std::memory_order_relaxed);
+
+    shard.retired.push_back({ instance, Epoch::Current() });
+
+    if(shard.retired.size() >= RECLAIM) {
+        Reclaim(shard);
+    }
+}
+
+template<typename T, class Mtx, size_t S, size_t N, size_t A>
+size_t ConcurrentPool<T, Mtx, S, N, A>::Reclaim(Shard& shard) {
+    Epoch::Advance();
+
+    // retired in epoch order
+    size_t reclaimed = 0;
+    for(; reclaimed < shard.retired.size() && Epoch::Reclaimable(shard.retired[reclaimed].epoch); ++reclaimed) {
+        shard.retired[reclaimed].instance->~T();
+        shard.allocator.Deallocate(shard.retired[reclaimed].instance);
+    }
+    shard.retired.erase(shard.retired.begin(), shard.retired.begin() + reclaimed);
+    return reclaimed;
+}
+
+template<typename T, class Mtx, size_t S, size_t N, size_t A>
+size_t ConcurrentPool<T, Mtx, S, N, A>::Segment(size_t index) {
+    return index < SEGMENT ? 0 : std::bit_width(index / SEGMENT);
+}
+
+template<typename T, class Mtx, size_t S, size_t N, size_t A>
+size_t ConcurrentPool<T, Mtx, S, N, A>::Base(size_t segment) {
+    return segment == 0 ? 0 : SEGMENT << (segment - 1);
+}
+
+#endif
@@ -4,11 +4,24 @@
 namespace EConfig {
 
 enum {
-    MEMORY_ALIGNMENT_DEFAULT   = 8,
-    MEMORY_ALLOCATE_DEFAULT    = 64,
-    BUFFER_SIZE_DEFAULT        = 4096,
-    LOCK_SPIN_COUNT_DEFAULT    = 4000,
-    LOCK_BACKOFF_LIMIT_DEFAULT = 0,
+    MEMORY_ALIGNMENT_DEFAULT       = 8,
+    MEMORY_ALLOCATE_DEFAULT        = 64,
+    MEMORY_CACHE_DEFAULT           = 32,
+    MEMORY_CACHE_INSTANCE_DEFAULT  = 4,
+    MEMORY_HUGE_PAGE_DEFAULT       = 2 << 20,
+    MEMORY_SIZE_CLASS_SPAN_DEFAULT = 64 << 10,
+    MEMORY_CACHE_LINE_DEFAULT      = 64,
+    BUFFER_SIZE_DEFAULT            = 4096,
+    POOL_SPARSE_PAGE_DEFAULT       = 1024,
+    POOL_SHARD_DEFAULT             = 8,
+    POOL_SEGMENT_DEFAULT           = 1024,
+    POOL_RECLAIM_DEFAULT           = 64,
+    EXECUTOR_GRAIN_DEFAULT         = 1024,
+    RING_CAPACITY_DEFAULT          = 1024,
+    LOCK_SPIN_COUNT_DEFAULT        = 4000,
+    LOCK_BACKOFF_LIMIT_DEFAULT     = 0,
+    LOCK_PAUSE_LIMIT_DEFAULT       = 1024,
+    LOCK_PARK_SPIN_DEFAULT         = 128,
 };
 
 } // namespace EConfig
@@ -0,0 +1,70 @@
+#ifndef LWE_UTILITIES_DENSEPOOL_HPP
+#define LWE_UTILITIES_DENSEPOOL_HPP
+
+#include <span>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+#include "id.hpp"
+#include "sparseset.hpp"
+#include "trace.hpp"
+
+/*
+    dense pool, live values contiguous
+    - values are owned by the pool, not shared by ID like Pool
+    - column i holds the i-th type of every live value, in the order of IDs()
+    - Erase swaps the last value into the hole, order is swap-remove order
+    - ID lookup: SparseSet, sparse page by ID index, then dense index, O(1), stale generation rejected
+    - iteration: linear walk of the columns, no ID, no indirection
+
+    layout
+    - DensePool<T>           : one column of T (AoS)
+    - DensePool<A, B, C ...> : one column per field (SoA), Insert(a, b, c ...)
+    - a pointer or span into a column is invalidated by Insert / Erase
+    - Insert that throws leaves the pool as it was, columns rolled back, ID released
+
+    use
+
+    DensePool<Transform> transforms;
+    ID id = transforms.Insert(Transform{ ... });
+    transforms.Find(id)->position += velocity;
+    for(Transform& transform : transforms.Data()) { ... }
+
+    DensePool<Position, Velocity> bodies;
+    ID id = bodies.Insert(Position{}, Velocity{ 1, 0 });
+    bodies.Find<1>(id)->x = 2;
+    bodies.ForEach([](Position& position, Velocity& velocity) { position += velocity; });
+*/
+template<typename... Ts> class DensePool {
+public:
+    static_assert(sizeof...(Ts) > 0, "DensePool needs a column.");
+
+public:
+    template<size_t I> using Column = std::tuple_element_t<I, std::tuple<Ts...>>;
+
+public:
+    template<typename... Args> ID Insert(Args&&...); // one type: constructor arguments, columns: one per column
+    bool                          Erase(ID);
+    void                          Clear();
+
+public:
+    template<size_t I = 0> Column<I>* Find(ID); // null: not found
+    bool                              Exist(ID) const;
+    size_t                            Size() const;
+    size_t                            GetIndex(ID) const; // INVALID_INDEX: not found
+    ID                                GetID(size_t) const;
+
+public:
+    template<size_t I = 0> std::span<Column<I>> Data(); // dense, order of IDs()
+    std::span<const ID>                         IDs() const;
+    template<typename F> void                   ForEach(F&&); // f(Ts&...)
+
+private:
+    std::tuple<std::vector<Ts>...> columns;
+    SparseSet                      set; // dense index to ID, ID index to dense index
+    ID::Manager                    ids;
+};
+
+#include "densepool.ipp"
+#endif
@@ -0,0 +1,133 @@
+#include "densepool.hpp"
+
+#ifdef LWE_UTILITIES_DENSEPOOL_HPP
+
+template<typename... Ts>
+template<typename... Args>
+ID DensePool<Ts...>::Insert(Args&&... args) {
+    ID id = ids.Generate();
+    if(id == ECode::INVALID_ID) {
+        return ID::Invalid(); // exhausted
+    }
+
+    size_t index = set.table.size();
+    size_t done  = 0; // columns constructed
+
+    try {
+        size_t& slot = set.Slot(id); // page allocated before anything is added
+        set.table.push_back(id);
+
+        if constexpr(sizeof...(Ts) == 1) {
+            std::get<0>(columns).emplace_back(std::forward<Args>(args)...);
+        }
+        else {
+            static_assert(sizeof...(Args) == sizeof...(Ts), "One argument per column.");
+            [&]<size_t... I>(std::index_sequence<I...>) {
+                ((std::get<I>(columns).emplace_back(std::forward<Args>(args)), ++done), ...);
+            }(std::index_sequence_for<Ts...>{});
+        }
+
+        slot = index;
+    }
+
+    // column k threw, columns before it and the table hold the new value
+    catch(...) {
+        [&]<size_t... I>(std::index_sequence<I...>) {
+            ((I < done ? std::get<I>(columns).pop_back() : void()), ...);
+        }(std::index_sequence_for<Ts...>{});
+
+        if(set.table.size() > index) {
+            set.table.pop_back();
+        }
+        ids.Release(id);
+        throw;
+    }
+
+    Trace::Write(Trace::INSERT, id, (sizeof(Ts) + ...));
+    return id;
+}
+
+template<typename... Ts> bool DensePool<Ts...>::Erase(ID id) {
+    size_t index = GetIndex(id);
+    if(index == size_t(ECode::INVALID_INDEX)) {
+        return false;
+    }
+
+    Trace::Write(Trace::ERASE, id, (sizeof(Ts) + ...));
+
+    // swap remove, every column the same way
+    size_t last = set.table.size() - 1;
+    auto remove = [&](auto& column) {
+        if(index != last) {
+            column[index] = std::move(column[last]);
+        }
+        column.pop_back();
+    };
+    std::apply([&](std::vector<Ts>&... column) { (remove(column), ...); }, columns);
+
+    set.Remove(index);
+    ids.Release(id);
+    return true;
+}
+
+template<typename... Ts> void DensePool<Ts...>::Clear() {
+    for(ID id : set.table) {
+        Trace::Write(Trace::ERASE, id, (sizeof(Ts) + ...));
+        set.Slot(id) = ECode::INVALID_INDEX;
+        ids.Release(id);
+    }
+
+    std::apply([](std::vector<Ts>&... column) { (column.clear(), ...); }, columns);
+    set.table.clear();
+}
+
+template<typename... Ts>
+template<size_t I>
+auto DensePool<Ts...>::Find(ID id) -> Column<I>* {
+    size_t index = GetIndex(id);
+    if(index == size_t(ECode::INVALID_INDEX)) {
+        return nullptr;
+    }
+    return &std::get<I>(columns)[index];
+}
+
+template<typename... Ts> bool DensePool<Ts...>::Exist(ID id) const {
+    return GetIndex(id) != size_t(ECode::INVALID_INDEX);
+}
+
+template<typename... Ts> size_t DensePool<Ts...>::Size() const {
+    return set.table.size();
+}
+
+template<typename... Ts> size_t DensePool<Ts...>::GetIndex(ID id) const {
+    return set.Find(id);
+}
+
+template<typename... Ts> ID DensePool<Ts...>::GetID(size_t index) const {
+    if(index >= set.table.size()) {
+        return ID::Invalid();
+    }
+    return set.table[index];
+}
+
+template<typename... Ts>
+template<size_t I>
+auto DensePool<Ts...>::Data() -> std::span<Column<I>> {
+    return std::get<I>(columns);
+}
+
+template<typename... Ts> std::span<const ID> DensePool<Ts...>::IDs() const {
+    return set.table;
+}
+
+template<typename... Ts>
+template<typename F>
+void DensePool<Ts...>::ForEach(F&& f) {
+    std::apply([&](std::vector<Ts>&... column) {
+        for(size_t i = 0, size = set.table.size(); i < size; ++i) {
+            f(column.data()[i]...); // no bounds check per element
+        }
+    }, columns);
+}
+
+#endif
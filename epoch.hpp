@@ -0,0 +1,80 @@
+#ifndef LWE_UTILITIES_EPOCH_HPP
+#define LWE_UTILITIES_EPOCH_HPP
+
+#include <atomic>
+#include <cstdint>
+
+#include "config.h"
+#include "macro.h"
+
+/*
+    epoch based reclamation, process wide
+    - reader pins the current epoch with Guard, one store to its own line, no lock
+    - writer unlinks first, then tags the retired object with Current()
+    - retired at epoch e is freed once Reclaimable(e): every reader pinned since has left
+    - Advance moves the epoch when every pinned reader is in the current one
+
+    records
+    - one per thread, reused after the thread exits, never freed
+    - guards nest, the outermost pins
+
+    use
+
+    {
+        Epoch::Guard guard;
+        T* ptr = table.Find(id); // valid until guard ends
+    }
+
+    // writer
+    unlink(ptr);
+    retired.push_back({ ptr, Epoch::Current() });
+
+    Epoch::Advance();
+    if(Epoch::Reclaimable(retired[0].epoch)) delete retired[0].ptr;
+*/
+class Epoch {
+public:
+    NO_INSTANTIABLE(Epoch);
+
+public:
+    class Guard {
+    public:
+        NO_COPYABLE(Guard);
+        NO_MOVABLE(Guard);
+
+    public:
+        Guard();
+        ~Guard();
+    };
+
+public:
+    static uint64_t Current();
+    static bool     Advance();             // false: a reader is behind
+    static bool     Reclaimable(uint64_t); // retired at, no reader can see it
+
+private:
+    struct alignas(EConfig::MEMORY_CACHE_LINE_DEFAULT) Record {
+        std::atomic<uint64_t> epoch = 0; // 0: quiescent
+        std::atomic_bool      used  = false;
+        uint32_t              depth = 0; // owner only
+        Record*               next  = nullptr;
+    };
+
+    struct Domain {
+        std::atomic<uint64_t> epoch = 1;
+        std::atomic<Record*>  head  = nullptr;
+    };
+
+    struct Local {
+        Local();
+        ~Local();
+        Record* record;
+    };
+
+private:
+    static Domain& Instance(); // outlives every Local
+    static Record& Acquire();  // record of this thread
+};
+
+#include "epoch.ipp"
+#endif
@@ -0,0 +1,77 @@
+#include "epoch.hpp"
+
+#ifdef LWE_UTILITIES_EPOCH_HPP
+
+inline Epoch::Guard::Guard() {
+    Record& record = Acquire();
+    if(record.depth++ == 0) {
+        // pinned before any read, total order with the unlink of writers
+        record.epoch.store(Instance().epoch.load(std::memory_order_relaxed), std::memory_order_seq_cst);
+    }
+}
+
+inline Epoch::Guard::~Guard() {
+    Record& record = Acquire();
+    if(--record.depth == 0) {
+        record.epoch.store(0, std::memory_order_release);
+    }
+}
+
+inline uint64_t Epoch::Current() {
+    return Instance().epoch.load(std::memory_order_seq_cst);
+}
+
+inline bool Epoch::Advance() {
+    Domain&  domain  = Instance();
+    uint64_t current = domain.epoch.load(std::memory_order_seq_cst);
+
+    for(Record* record = domain.head.load(std::memory_order_acquire); record; record = record->next) {
+        uint64_t pinned = record->epoch.load(std::memory_order_seq_cst);
+        if(pinned != 0 && pinned != current) {
+            return false;
+        }
+    }
+
+    // fails only when another writer moved it already
+    domain.epoch.compare_exchange_strong(current, current + 1, std::memory_order_seq_cst);
+    return true;
+}
+
+inline bool Epoch::Reclaimable(uint64_t retired) {
+    return Current() >= retired + 2;
+}
+
+inline Epoch::Local::Local() {
+    Domain& domain = Instance();
+
+    // thread exited
+    for(record = domain.head.load(std::memory_order_acquire); record; record = record->next) {
+        bool used = false;
+        if(!record->used.load(std::memory_order_relaxed) && record->used.compare_exchange_strong(used, true, std::memory_order_acquire)) {
+            return;
+        }
+    }
+
+    record       = new Record();
+    record->used = true;
+    record->next = domain.head.load(std::memory_order_relaxed);
+    while(!domain.head.compare_exchange_weak(record->next, record, std::memory_order_release, std::memory_order_relaxed)) {}
+}
+
+inline Epoch::Local::~Local() {
+    record->epoch.store(0, std::memory_order_relaxed);
+    record->depth = 0;
+    record->used.store(false, std::memory_order_release);
+}
+
+inline auto Epoch::Instance() -> Domain& {
+    static Domain domain;
+    return domain;
+}
+
+inline auto Epoch::Acquire() -> Record& {
+    static thread_local Local local;
+    return *local.record;
+}
+
+#endif
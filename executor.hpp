@@ -0,0 +1,95 @@
+#ifndef LWE_UTILITIES_EXECUTOR_HPP
+#define LWE_UTILITIES_EXECUTOR_HPP
+
+#include <atomic>
+#include <exception>
+#include <memory>
+#include <optional>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+#include "config.h"
+#include "macro.h"
+
+/*
+    work stealing executor for index ranges
+    - N participants: N - 1 worker threads and the calling thread
+    - For splits [begin, end) into one contiguous slice per participant
+    - each participant claims grain sized chunks of its slice, then steals chunks of the others
+    - a claim is one fetch_add on the cursor of a slice, no task object, no allocation per chunk
+    - one job at a time, a nested or concurrent call runs on the calling thread alone
+    - first exception is rethrown to the caller, remaining chunks are skipped
+
+    Reduce
+    - f(first, last) -> R per chunk, join(R, R) -> R
+    - join order is not fixed, join must be associative and commutative
+
+    use
+
+    Executor& executor = Executor::Instance(); // hardware_concurrency participants
+
+    executor.For(0, values.size(), 1024, [&](size_t first, size_t last) {
+        for(size_t i = first; i < last; ++i) Update(values[i]);
+    });
+
+    uint64_t sum = executor.Reduce<uint64_t>(0, values.size(), 1024, 0,
+        [&](size_t first, size_t last) { return Sum(values, first, last); },
+        [](uint64_t a, uint64_t b) { return a + b; });
+*/
+class Executor {
+public:
+    NO_COPYABLE(Executor);
+    NO_MOVABLE(Executor);
+
+public:
+    Executor(size_t participants = 0); // 0: hardware concurrency
+    ~Executor();
+
+public:
+    static Executor& Instance(); // process wide, started on first use
+
+public:
+    template<typename F> void For(size_t begin, size_t end, size_t grain, F&& f); // f(first, last)
+    template<typename R, typename F, typename Join>
+    R Reduce(size_t begin, size_t end, size_t grain, R init, F&& f, Join&& join); // f(first, last) -> R
+
+public:
+    size_t Participants() const;
+
+private:
+    using Body = void (*)(void*, size_t participant, size_t first, size_t last);
+
+    struct alignas(EConfig::MEMORY_CACHE_LINE_DEFAULT) Slice {
+        std::atomic<size_t> next = 0;
+        size_t              end  = 0;
+    };
+
+    struct Job {
+        Body   body;
+        void*  context;
+        size_t grain;
+    };
+
+private:
+    void Run(size_t begin, size_t end, size_t grain, Body, void*); // blocks until done
+    void Work(size_t participant);
+    void Loop(size_t participant); // worker thread
+
+private:
+    std::unique_ptr<Slice[]> slices;
+    std::vector<std::thread> workers;
+    size_t                   count;
+
+private:
+    std::atomic_flag      busy       = ATOMIC_FLAG_INIT;
+    std::atomic<uint64_t> generation = 0; // job number, workers wait on it
+    std::atomic<size_t>   pending    = 0; // workers not done with the job
+    std::atomic_bool      failed     = false;
+    std::exception_ptr    error;
+    Job                   job        = {};
+    bool                  stop       = false;
+};
+
+#include "executor.ipp"
+#endif
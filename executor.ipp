@@ -0,0 +1,159 @@
+#include "executor.hpp"
+
+#ifdef LWE_UTILITIES_EXECUTOR_HPP
+
+inline Executor::Executor(size_t participants): count(participants) {
+    if(count == 0) {
+        count = std::thread::hardware_concurrency();
+    }
+    if(count == 0) {
+        count = 1;
+    }
+
+    slices = std::make_unique<Slice[]>(count);
+
+    // last participant is the caller
+    workers.reserve(count - 1);
+    for(size_t i = 0; i < count - 1; ++i) {
+        workers.emplace_back(&Executor::Loop, this, i);
+    }
+}
+
+inline Executor::~Executor() {
+    stop = true;
+    generation.fetch_add(1, std::memory_order_release);
+    generation.notify_all();
+
+    for(std::thread& worker : workers) {
+        worker.join();
+    }
+}
+
+inline Executor& Executor::Instance() {
+    static Executor executor;
+    return executor;
+}
+
+template<typename F> void Executor::For(size_t begin, size_t end, size_t grain, F&& f) {
+    Run(begin, end, grain, [](void* context, size_t, size_t first, size_t last) {
+        (*static_cast<std::remove_reference_t<F>*>(context))(first, last);
+    }, &f);
+}
+
+template<typename R, typename F, typename Join>
+R Executor::Reduce(size_t begin, size_t end, size_t grain, R init, F&& f, Join&& join) {
+    struct Context {
+        F&                            f;
+        Join&                         join;
+        std::vector<std::optional<R>> partial; // per participant, one allocation per call
+    } context{ f, join, std::vector<std::optional<R>>(count) };
+
+    Run(begin, end, grain, [](void* ptr, size_t participant, size_t first, size_t last) {
+        Context&          context = *static_cast<Context*>(ptr);
+        std::optional<R>& partial = context.partial[participant];
+
+        R value = context.f(first, last);
+        partial = partial ? context.join(std::move(*partial), std::move(value)) : std::move(value);
+    }, &context);
+
+    for(std::optional<R>& partial : context.partial) {
+        if(partial) {
+            init = join(std::move(init), std::move(*partial));
+        }
+    }
+    return init;
+}
+
+inline size_t Executor::Participants() const {
+    return count;
+}
+
+inline void Executor::Run(size_t begin, size_t end, size_t grain, Body body, void* context) {
+    if(begin >= end) {
+        return;
+    }
+    if(grain == 0) {
+        grain = 1;
+    }
+
+    // nested or concurrent call, or not worth a wake up
+    if(count == 1 || end - begin <= grain || busy.test_and_set(std::memory_order_acquire)) {
+        for(size_t first = begin; first < end; first += grain) {
+            body(context, 0, first, end - first < grain ? end : first + grain);
+        }
+        return;
+    }
+
+    size_t size = (end - begin + count - 1) / count;
+    for(size_t i = 0; i < count; ++i) {
+        size_t first = begin + size * i;
+        slices[i].end = first + size < end ? first + size : end;
+        slices[i].next.store(first < end ? first : end, std::memory_order_relaxed);
+    }
+
+    job = { body, context, grain };
+    failed.store(false, std::memory_order_relaxed);
+    error = nullptr;
+
+    pending.store(count - 1, std::memory_order_relaxed);
+    generation.fetch_add(1, std::memory_order_release); // job and slices published
+    generation.notify_all();
+
+    Work(count - 1);
+
+    for(size_t left = pending.load(std::memory_order_acquire); left != 0; left = pending.load(std::memory_order_acquire)) {
+        pending.wait(left, std::memory_order_acquire);
+    }
+
+    std::exception_ptr thrown = error;
+    busy.clear(std::memory_order_release);
+
+    if(thrown) {
+        std::rethrow_exception(thrown);
+    }
+}
+
+inline void Executor::Work(size_t participant) {
+    // own slice first, then the next ones
+    for(size_t i = 0; i < count; ++i) {
+        Slice& slice = slices[(participant + i) % count];
+
+        while(!failed.load(std::memory_order_relaxed)) {
+            size_t first = slice.next.fetch_add(job.grain, std::memory_order_relaxed);
+            if(first >= slice.end) {
+                break;
+            }
+
+            size_t last = slice.end - first < job.grain ? slice.end : first + job.grain;
+            try {
+                job.body(job.context, participant, first, last);
+            }
+            catch(...) {
+                if(!failed.exchange(true, std::memory_order_acq_rel)) {
+                    error = std::current_exception();
+                }
+            }
+        }
+    }
+}
+
+inline void Executor::Loop(size_t participant) {
+    uint64_t seen = 0;
+
+    while(true) {
+        generation.wait(seen, std::memory_order_acquire);
+        seen = generation.load(std::memory_order_acquire);
+
+        if(stop) {
+            return;
+        }
+
+        Work(participant);
+
+        if(pending.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+            pending.notify_one();
+        }
+    }
+}
+
+#endif
@@ -1,20 +1,46 @@
 #ifndef LWE_ID_HPP
 #define LWE_ID_HPP
 
+#include <cstdint>
 #include <functional>
-#include <optional>
 #include <queue>
 #include <stdexcept>
+#include <vector>
 
 #include "config.h"
 
-// default id
+/*
+    default id, generational handle
+    - low INDEX_BITS: slot index, 0 is invalid
+    - high bits     : generation of the slot, bumped on every release
+    - a stale ID never equals the ID reusing its slot, one compare rejects it
+
+    Manager
+    - slots hold the generation and an intrusive free list, Generate / Release are O(1)
+    - RECENT: last released first (default), LOWEST: lowest index first for density, O(log n)
+
+    use
+
+    ID::Manager manager;
+    ID a = manager.Generate(); // index 1, generation 0
+    manager.Release(a);
+    ID b = manager.Generate(); // index 1, generation 1
+    a == b;                    // false
+    manager.Alive(a);          // false
+
+    UID<Entity>::SetReuse(ID::Manager::LOWEST);
+*/
 struct ID {
 public:
     using Value = size_t;
 
+public:
+    static constexpr size_t INDEX_BITS = 32;
+    static constexpr Value  INDEX_MASK = (Value(1) << INDEX_BITS) - 1;
+
 public:
     static ID Invalid();
+    static ID Make(Value index, uint32_t generation);
 
 public:
     explicit ID(Value = ECode::INVALID_ID);
@@ -22,6 +48,10 @@ public:
     ID& operator=(const ID&);
     operator Value() const;
 
+public:
+    Value    Index() const;
+    uint32_t Generation() const;
+
 private:
     Value value;
 
@@ -34,24 +64,44 @@ public:
     class Manager {
     public:
         using Value = ID::Value;
-        using Cache = std::priority_queue<Value>;
+
+        enum Reuse {
+            RECENT,
+            LOWEST,
+        };
 
     public:
+        Manager(Reuse = RECENT);
         ~Manager();
 
     public:
         ID   Generate();
         void Release(ID);
         ID   Preview() const;
+        bool Alive(ID) const;
+        void SetReuse(Reuse); // free slots are kept
+        void Reserve(size_t); // slots for N live IDs, no growth up to N
 
     private:
-        Value next = 1;
-        Cache cache;
-        bool  terminated = false;
-    };
+        static constexpr uint32_t LIVE = UINT32_MAX; // next of a slot in use
 
-private:
-    static std::vector<std::optional<uint64_t>> hashed;
+        struct Slot {
+            uint32_t generation = 0;
+            uint32_t next       = LIVE; // free list, 0: end
+        };
+
+        using Lowest = std::priority_queue<uint32_t, std::vector<uint32_t>, std::greater<uint32_t>>;
+
+    private:
+        void Push(uint32_t); // free slot
+
+    private:
+        std::vector<Slot> slots = { Slot() }; // [0] reserved, invalid
+        uint32_t          free  = 0;          // RECENT head
+        Lowest            lowest;             // LOWEST
+        Reuse             reuse;
+        bool              terminated = false;
+    };
 };
 
 // unique id
@@ -80,7 +130,10 @@ public:
     operator Value() const;
 
 public:
-    static ID Preview();
+    static ID   Preview();
+    static bool Alive(ID);
+    static void SetReuse(ID::Manager::Reuse);
+    static void Reserve(size_t);
 
 private:
     ID id;
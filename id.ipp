@@ -3,31 +3,28 @@
 
 template <class T> ID::Manager UID<T>::gid;
 
-std::vector<std::optional<uint64_t>> ID::hashed = { std::hash<ID::Value>()(0) };
-
-uint64_t ID::Hash::operator()(ID id) const {
-    return *hashed[Value(id)];
+inline uint64_t ID::Hash::operator()(ID id) const {
+    return std::hash<Value>()(id);
 }
 
-ID ID::Invalid() { return ID(ECode::INVALID_ID); }
+inline ID ID::Invalid() { return ID(ECode::INVALID_ID); }
 
-ID::ID(Value arg) : value(arg) {
-    if (arg >= hashed.size()) {
-        hashed.resize(arg + 1);
-    }
-    if (!hashed[arg]) {
-        hashed[arg] = std::hash<Value>()(arg);
-    }
-}
+inline ID ID::Make(Value index, uint32_t generation) { return ID(Value(generation) << INDEX_BITS | index); }
+
+inline ID::ID(Value arg) : value(arg) {}
 
-ID::ID(const ID& arg) : value(arg.value) {}
+inline ID::ID(const ID& arg) : value(arg.value) {}
 
-ID& ID::operator=(const ID& ref) {
+inline ID& ID::operator=(const ID& ref) {
     value = ref.value;
     return *this;
 }
 
-ID::operator Value() const { return value; }
+inline ID::operator Value() const { return value; }
+
+inline ID::Value ID::Index() const { return value & INDEX_MASK; }
+
+inline uint32_t ID::Generation() const { return uint32_t(value >> INDEX_BITS); }
 
 template <class T> void UID<T>::Generate() {
     if (id == ECode::INVALID_ID) {
@@ -76,64 +73,120 @@ template <class T> UID<T>::operator Value() const { return id; }
 
 template <class T> ID UID<T>::Preview() { return gid.Preview(); }
 
-ID::Manager::~Manager() { terminated = true; }
+template <class T> bool UID<T>::Alive(ID id) { return gid.Alive(id); }
+
+template <class T> void UID<T>::SetReuse(ID::Manager::Reuse reuse) { gid.SetReuse(reuse); }
+
+template <class T> void UID<T>::Reserve(size_t count) { gid.Reserve(count); }
+
+inline ID::Manager::Manager(Reuse reuse) : reuse(reuse) {}
+
+inline ID::Manager::~Manager() { terminated = true; }
 
-ID ID::Manager::Generate() {
+inline ID ID::Manager::Generate() {
     if (terminated) {
         return ID::Invalid();
     }
 
-    if (cache.empty()) {
-        if (next == ECode::INVALID_ID) {
-            return ID::Invalid();
-        }
-        else {
-            return ID{next++};
+    uint32_t index;
+
+    if (reuse == RECENT && free) {
+        index = free;
+        free  = slots[index].next;
+    }
+
+    else if (reuse == LOWEST && !lowest.empty()) {
+        index = lowest.top();
+        lowest.pop();
+    }
+
+    else {
+        if (slots.size() >= INDEX_MASK) {
+            return ID::Invalid(); // exhausted
         }
+        index = uint32_t(slots.size());
+        slots.emplace_back();
     }
 
-    Value id = cache.top();
-    cache.pop();
-    return ID(id);
+    slots[index].next = LIVE;
+    return Make(index, slots[index].generation);
 }
 
-void ID::Manager::Release(ID id) {
+inline void ID::Manager::Release(ID id) {
     if (terminated == true) {
         return;
     }
 
-    if (id >= next) {
+    if (id == ECode::INVALID_ID) {
+        return;
+    }
+
+    // released, stale or never generated
+    if (!Alive(id)) {
         throw std::runtime_error("Disallowed or duplicate ID.");
     }
 
-    if (id == ECode::INVALID_ID) {
+    Slot& slot = slots[id.Index()];
+
+    // retire on wrap, a stale ID would match again
+    if (++slot.generation == UINT32_MAX) {
+        slot.next = 0;
         return;
     }
+    Push(uint32_t(id.Index()));
+}
 
-    // check chained value
-    if (id == next - 1) {
-        --next;
+inline ID ID::Manager::Preview() const {
+    if (reuse == RECENT && free) {
+        return Make(free, slots[free].generation);
+    }
+    if (reuse == LOWEST && !lowest.empty()) {
+        return Make(lowest.top(), slots[lowest.top()].generation);
+    }
+    if (slots.size() >= INDEX_MASK) {
+        return ID::Invalid();
+    }
+    return Make(slots.size(), 0);
+}
 
-        // pop chained value
-        while (!cache.empty()) {
-            if (cache.top() == next - 1) {
-                cache.pop();
-                --next;
-            } else
-                break;
-        }
+inline bool ID::Manager::Alive(ID id) const {
+    Value index = id.Index();
+    return index != 0 && index < slots.size() && slots[index].next == LIVE && slots[index].generation == id.Generation();
+}
+
+inline void ID::Manager::Reserve(size_t count) {
+    slots.reserve(1 + count); // [0] reserved
+}
+
+inline void ID::Manager::SetReuse(Reuse arg) {
+    if (reuse == arg) {
+        return;
     }
 
-    else {
-        cache.push(id); // wait for reuse
+    // move free slots to the other order
+    std::vector<uint32_t> released;
+    for (; free; free = slots[free].next) {
+        released.push_back(free);
+    }
+    for (; !lowest.empty(); lowest.pop()) {
+        released.push_back(lowest.top());
+    }
+
+    reuse = arg;
+    for (uint32_t index : released) {
+        Push(index);
     }
 }
 
-ID ID::Manager::Preview() const {
-    if (!cache.empty()) {
-        return ID(cache.top());
+inline void ID::Manager::Push(uint32_t index) {
+    if (reuse == RECENT) {
+        slots[index].next = free;
+        free              = index;
+    }
+    else {
+        slots[index].next = 0;
+        lowest.push(index);
     }
-    return ID(next);
 }
 
 template <typename T> Identifier<T>::Identifier() : id(false) {}
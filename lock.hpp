@@ -2,9 +2,23 @@
 #define LWE_UTILITIES_LOCK_HPP
 
 #include <atomic>
+#include <bit>
 #include <chrono>
+#include <climits>
+#include <cstdint>
+#include <stdexcept>
 #include <thread>
 
+#if defined(_MSC_VER)
+#    include <intrin.h>
+#endif
+
+#if defined(__linux__)
+#    include <linux/futex.h>
+#    include <sys/syscall.h>
+#    include <unistd.h>
+#endif
+
 #include "config.h"
 #include "macro.h"
 
@@ -43,8 +57,59 @@
     // auto unlock
 
     std::lock_guard<SpinLock> l;
+
+    stats
+    - compile with LWE_LOCK_STATS, otherwise INFO is always zero and nothing is measured
+    - every lock here keeps Contention::Usage, read by lock.INFO like Memory::INFO (DisableLock: zero)
+    - acquire, contended, spin (backoff rounds), reentrant (SpinLock only)
+    - wait / hold: histogram of log2 nanoseconds, [i] counts 2^(i-1) ~ 2^i ns
+    - counted while the lock is held, no atomic, read is approximate
+
+    Allocator<Packet, TTASLock> packets;
+    packets.Locker().INFO.contended;
+    TypeLock<Packet>::Info().wait[10]; // about 1 us
 */
-class SpinLock {
+class Contention {
+public:
+    static constexpr size_t BUCKET = 32;
+
+    struct Usage {
+        uint64_t acquire;
+        uint64_t contended;
+        uint64_t spin;
+        uint64_t reentrant;
+        uint64_t wait[BUCKET]; // log2 ns
+        uint64_t hold[BUCKET]; // log2 ns
+    };
+
+protected:
+    Contention();
+
+protected:
+    static uint64_t Now(); // ns, 0 without stats
+
+protected:
+    void OnAcquire(uint64_t since, uint64_t spin);
+    void OnReentrant();
+    void OnRelease();
+
+#ifdef LWE_LOCK_STATS
+private:
+    static size_t Bucket(uint64_t);
+
+private:
+    Usage    usage = { 0 };
+    uint64_t held  = 0; // acquired at
+
+public:
+    const Usage& INFO;
+#else
+public:
+    static const Usage INFO;
+#endif
+};
+
+class SpinLock: public Contention {
 public:
     NO_COPYABLE(SpinLock);
     NO_MOVABLE(SpinLock);
@@ -75,10 +140,180 @@ public:
     void unlock();
 };
 
+/*
+    scalable locks
+    - usable as Mtx of Allocator, Buffer, TypeLock, IndexLock
+    - never throw, not reentrant
+
+    TTASLock
+    - test and test-and-set, waiters only read the line until it is released
+    - exponential pause backoff up to LOCK_PAUSE_LIMIT_DEFAULT, then yield
+
+    TicketLock
+    - FIFO, one fetch_add per lock
+    - waiters read the serving counter only
+
+    MCSLock
+    - FIFO queue, each waiter spins on its own node
+    - nodes are thread local, 64 locks held at once per thread, then heap
+
+    FutexLock
+    - spins LOCK_PARK_SPIN_DEFAULT times, then parks in kernel
+    - Linux futex, otherwise std::atomic wait
+
+    choose
+    - short section, few threads   : TTASLock
+    - fairness                     : TicketLock
+    - many cores on one lock       : MCSLock
+    - long section, oversubscribed : FutexLock
+
+    use
+
+    Allocator<Packet, MCSLock> packets;
+    Buffer<4096, FutexLock>    buffer;
+    TypeLock<Packet, TTASLock> lock;
+*/
+class Backoff {
+public:
+    static void Pause(); // cpu relax hint
+
+public:
+    void Wait(); // pause 1, 2, 4 ... LOCK_PAUSE_LIMIT_DEFAULT times, then yield
+
+private:
+    uint32_t delay = 1;
+
+public:
+    uint64_t count = 0; // Wait calls
+};
+
+/*
+    futex word wait / wake
+    - Linux futex, otherwise std::atomic wait / notify
+    - FutexLock and Parking of the rings
+*/
+class Futex {
+public:
+    NO_INSTANTIABLE(Futex);
+
+public:
+    static void Wait(std::atomic<uint32_t>&, uint32_t);           // park while word == value
+    static void Wake(std::atomic<uint32_t>&, uint32_t count = 1); // count waiters, std::atomic: one or all
+};
+
+class TTASLock: public Contention {
+public:
+    NO_COPYABLE(TTASLock);
+    NO_MOVABLE(TTASLock);
+    TTASLock() = default;
+
+public:
+    void Lock();
+    void Unlock();
+    bool TryLock();
+
+private:
+    std::atomic_bool flag = false;
+
+public:
+    void lock();
+    void unlock();
+    bool try_lock();
+};
+
+class TicketLock: public Contention {
+public:
+    NO_COPYABLE(TicketLock);
+    NO_MOVABLE(TicketLock);
+    TicketLock() = default;
+
+public:
+    void Lock();
+    void Unlock();
+    bool TryLock();
+
+private:
+    std::atomic<uint32_t> next    = 0;
+    std::atomic<uint32_t> serving = 0;
+
+public:
+    void lock();
+    void unlock();
+    bool try_lock();
+};
+
+class MCSLock: public Contention {
+public:
+    NO_COPYABLE(MCSLock);
+    NO_MOVABLE(MCSLock);
+    MCSLock() = default;
+
+private:
+    struct alignas(EConfig::MEMORY_CACHE_LINE_DEFAULT) Node {
+        std::atomic<Node*> next = nullptr;
+        std::atomic_bool   wait = false;
+    };
+
+    struct Nodes {
+        Node     node[64];
+        uint64_t used = 0; // bit per node
+    };
+
+public:
+    void Lock();
+    void Unlock();
+    bool TryLock();
+
+private:
+    static Node* Acquire(); // node of this thread
+    static void  Free(Node*);
+
+private:
+    std::atomic<Node*> tail   = nullptr;
+    Node*              holder = nullptr; // written by owner only
+
+private:
+    static thread_local Nodes nodes;
+
+public:
+    void lock();
+    void unlock();
+    bool try_lock();
+};
+
+class FutexLock: public Contention {
+public:
+    NO_COPYABLE(FutexLock);
+    NO_MOVABLE(FutexLock);
+    FutexLock(int = EConfig::LOCK_PARK_SPIN_DEFAULT);
+
+public:
+    void Lock();
+    void Unlock();
+    bool TryLock();
+
+private:
+    void Wait(uint32_t); // park while state == value
+    void Wake();         // one waiter
+
+private:
+    std::atomic<uint32_t> state = 0; // 0: free, 1: locked, 2: locked with waiters
+    int                   spin;
+
+public:
+    void lock();
+    void unlock();
+    bool try_lock();
+};
+
 /*
     void wrapper
+    - no Contention base, nothing to count, INFO is always zero
 */
 class DisableLock {
+public:
+    static constexpr Contention::Usage INFO = {};
+
 public:
     void Lock();
     void Unlock();
@@ -86,8 +321,15 @@ public:
     void unlock();
 };
 
+/*
+    lock-free tag
+    - Allocator: atomic chunk stack, SpinLock only for expanding
+*/
+class LockFree {};
+
 template<typename T> struct Lock { using Type = T; };
 template<> struct Lock<void> { using Type = DisableLock; };
+template<> struct Lock<LockFree> { using Type = SpinLock; };
 
 template<class Mtx> class LockGuard {
 public:
@@ -111,7 +353,8 @@ public:
 
 public:
     TypeLock();
-    LockType& Locker();
+    LockType&                       Locker();
+    static const Contention::Usage& Info();
 
 private:
     static LockType mtx;
@@ -123,7 +366,8 @@ public:
 
 public:
     IndexLock();
-    LockType& Locker();
+    LockType&                       Locker();
+    static const Contention::Usage& Info();
 
 private:
     static LockType mtx;
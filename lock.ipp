@@ -3,15 +3,78 @@
 
 #ifdef LWE_UTILITIES_LOCK_HPP
 
-SpinLock::SpinLock(int spin, int backoff): spin(spin), backoff(backoff) {}
+/*
+    Contention
+*/
 
-void SpinLock::Lock() {
+#ifdef LWE_LOCK_STATS
+
+inline Contention::Contention(): INFO(usage) {}
+
+inline uint64_t Contention::Now() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+inline void Contention::OnAcquire(uint64_t since, uint64_t spin) {
+    uint64_t now = Now();
+
+    ++usage.acquire;
+    if(spin) {
+        ++usage.contended;
+        usage.spin += spin;
+    }
+    ++usage.wait[Bucket(now - since)];
+
+    held = now;
+}
+
+inline void Contention::OnReentrant() {
+    ++usage.reentrant;
+}
+
+inline void Contention::OnRelease() {
+    ++usage.hold[Bucket(Now() - held)];
+}
+
+inline size_t Contention::Bucket(uint64_t ns) {
+    size_t bucket = std::bit_width(ns);
+    return bucket < BUCKET ? bucket : BUCKET - 1;
+}
+
+#else
+
+inline const Contention::Usage Contention::INFO = { 0 };
+
+inline Contention::Contention() {}
+
+inline uint64_t Contention::Now() {
+    return 0;
+}
+
+inline void Contention::OnAcquire(uint64_t, uint64_t) {}
+
+inline void Contention::OnReentrant() {}
+
+inline void Contention::OnRelease() {}
+
+#endif
+
+/*
+    SpinLock
+*/
+
+inline SpinLock::SpinLock(int spin, int backoff): spin(spin), backoff(backoff) {}
+
+inline void SpinLock::Lock() {
     std::thread::id id = std::this_thread::get_id();
     if(owner == id) {
         ++locked;
+        OnReentrant();
         return;
     }
 
+    uint64_t since = Now();
+
     int attempts = 0;
 
     if(backoff) {
@@ -34,30 +97,32 @@ void SpinLock::Lock() {
 
     owner = id;
     ++locked;
+    OnAcquire(since, attempts);
 }
 
-void SpinLock::Unlock() {
+inline void SpinLock::Unlock() {
     if(--locked == 0) {
+        OnRelease();
         owner = std::thread::id();
         flag.store(false, std::memory_order_release); // release the lock
     }
 }
 
-void SpinLock::SetSpinCount(int arg, int backoffLimit) {
+inline void SpinLock::SetSpinCount(int arg, int backoffLimit) {
     spin = arg;
     if(backoffLimit) {
         backoff = backoffLimit;
     }
 }
 
-void SpinLock::SetBackoffIncrement(int arg, int spinCount) {
+inline void SpinLock::SetBackoffIncrement(int arg, int spinCount) {
     backoff = arg;
     if(spinCount) {
         spin = spinCount;
     }
 }
 
-double SpinLock::GetBackoffWaitSec() {
+inline double SpinLock::GetBackoffWaitSec() {
     int n = 0;
     for(int i = 0; i < spin; ++i) {
         n += i * backoff;
@@ -65,14 +130,303 @@ double SpinLock::GetBackoffWaitSec() {
     return n * 1e-6;
 }
 
-void SpinLock::lock() {
+inline void SpinLock::lock() {
+    Lock();
+}
+
+inline void SpinLock::unlock() {
+    Unlock();
+}
+
+inline void Backoff::Pause() {
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+    _mm_pause();
+#elif defined(__x86_64__) || defined(__i386__)
+    __builtin_ia32_pause();
+#elif defined(__aarch64__) || defined(__arm__)
+    __asm__ __volatile__("yield");
+#else
+    std::atomic_signal_fence(std::memory_order_seq_cst);
+#endif
+}
+
+inline void Backoff::Wait() {
+    ++count;
+
+    // oversubscribed, let the holder run
+    if(delay > EConfig::LOCK_PAUSE_LIMIT_DEFAULT) {
+        std::this_thread::yield();
+        return;
+    }
+
+    for(uint32_t i = 0; i < delay; ++i) {
+        Pause();
+    }
+    delay <<= 1;
+}
+
+inline void Futex::Wait(std::atomic<uint32_t>& word, uint32_t value) {
+#if defined(__linux__)
+    syscall(SYS_futex, reinterpret_cast<uint32_t*>(&word), FUTEX_WAIT_PRIVATE, value, nullptr, nullptr, 0);
+#else
+    word.wait(value, std::memory_order_relaxed);
+#endif
+}
+
+inline void Futex::Wake(std::atomic<uint32_t>& word, uint32_t count) {
+#if defined(__linux__)
+    syscall(SYS_futex, reinterpret_cast<uint32_t*>(&word), FUTEX_WAKE_PRIVATE, count < INT_MAX ? int(count) : INT_MAX, nullptr, nullptr, 0);
+#else
+    if(count == 1) word.notify_one();
+    else word.notify_all();
+#endif
+}
+
+/*
+    TTASLock
+*/
+
+inline void TTASLock::Lock() {
+    uint64_t since = Now();
+    Backoff  backoff;
+
+    while(flag.exchange(true, std::memory_order_acquire)) {
+        // read only until released
+        while(flag.load(std::memory_order_relaxed)) {
+            backoff.Wait();
+        }
+    }
+    OnAcquire(since, backoff.count);
+}
+
+inline void TTASLock::Unlock() {
+    OnRelease();
+    flag.store(false, std::memory_order_release);
+}
+
+inline bool TTASLock::TryLock() {
+    if(flag.load(std::memory_order_relaxed) || flag.exchange(true, std::memory_order_acquire)) {
+        return false;
+    }
+    OnAcquire(Now(), 0);
+    return true;
+}
+
+inline void TTASLock::lock() {
+    Lock();
+}
+
+inline void TTASLock::unlock() {
+    Unlock();
+}
+
+inline bool TTASLock::try_lock() {
+    return TryLock();
+}
+
+/*
+    TicketLock
+*/
+
+inline void TicketLock::Lock() {
+    uint64_t since  = Now();
+    uint32_t ticket = next.fetch_add(1, std::memory_order_relaxed);
+    Backoff  backoff;
+
+    while(serving.load(std::memory_order_acquire) != ticket) {
+        backoff.Wait();
+    }
+    OnAcquire(since, backoff.count);
+}
+
+inline void TicketLock::Unlock() {
+    OnRelease();
+    serving.store(serving.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+}
+
+inline bool TicketLock::TryLock() {
+    uint32_t now    = serving.load(std::memory_order_acquire);
+    uint32_t ticket = now;
+    if(!next.compare_exchange_strong(ticket, now + 1, std::memory_order_acquire, std::memory_order_relaxed)) {
+        return false;
+    }
+    OnAcquire(Now(), 0);
+    return true;
+}
+
+inline void TicketLock::lock() {
+    Lock();
+}
+
+inline void TicketLock::unlock() {
+    Unlock();
+}
+
+inline bool TicketLock::try_lock() {
+    return TryLock();
+}
+
+/*
+    MCSLock
+*/
+
+inline thread_local MCSLock::Nodes MCSLock::nodes;
+
+inline void MCSLock::Lock() {
+    uint64_t since = Now();
+    Backoff  backoff;
+
+    Node* node = Acquire();
+    node->next.store(nullptr, std::memory_order_relaxed);
+    node->wait.store(true, std::memory_order_relaxed);
+
+    Node* prev = tail.exchange(node, std::memory_order_acq_rel);
+    if(prev) {
+        prev->next.store(node, std::memory_order_release);
+        while(node->wait.load(std::memory_order_acquire)) {
+            backoff.Wait();
+        }
+    }
+
+    holder = node;
+    OnAcquire(since, backoff.count);
+}
+
+inline void MCSLock::Unlock() {
+    OnRelease();
+
+    Node* node = holder;
+    Node* next = node->next.load(std::memory_order_acquire);
+
+    if(!next) {
+        // no waiter
+        Node* expected = node;
+        if(tail.compare_exchange_strong(expected, nullptr, std::memory_order_release, std::memory_order_relaxed)) {
+            Free(node);
+            return;
+        }
+
+        // waiter is linking
+        Backoff backoff;
+        while(!(next = node->next.load(std::memory_order_acquire))) {
+            backoff.Wait();
+        }
+    }
+
+    next->wait.store(false, std::memory_order_release);
+    Free(node);
+}
+
+inline bool MCSLock::TryLock() {
+    Node* node = Acquire();
+    node->next.store(nullptr, std::memory_order_relaxed);
+    node->wait.store(false, std::memory_order_relaxed);
+
+    Node* expected = nullptr;
+    if(tail.compare_exchange_strong(expected, node, std::memory_order_acq_rel, std::memory_order_relaxed)) {
+        holder = node;
+        OnAcquire(Now(), 0);
+        return true;
+    }
+
+    Free(node);
+    return false;
+}
+
+inline auto MCSLock::Acquire() -> Node* {
+    if(~nodes.used == 0) {
+        return new Node(); // more than 64 held by this thread
+    }
+
+    int index = std::countr_one(nodes.used);
+    nodes.used |= uint64_t(1) << index;
+    return &nodes.node[index];
+}
+
+inline void MCSLock::Free(Node* node) {
+    if(node < nodes.node || node >= nodes.node + 64) {
+        delete node;
+        return;
+    }
+    nodes.used &= ~(uint64_t(1) << (node - nodes.node));
+}
+
+inline void MCSLock::lock() {
     Lock();
 }
 
-void SpinLock::unlock() {
+inline void MCSLock::unlock() {
     Unlock();
 }
 
+inline bool MCSLock::try_lock() {
+    return TryLock();
+}
+
+/*
+    FutexLock
+*/
+
+inline FutexLock::FutexLock(int spin): spin(spin) {}
+
+inline void FutexLock::Lock() {
+    uint64_t since = Now();
+
+    for(int i = 0; i < spin; ++i) {
+        uint32_t expected = 0;
+        if(state.load(std::memory_order_relaxed) == 0 &&
+            state.compare_exchange_weak(expected, 1, std::memory_order_acquire, std::memory_order_relaxed)) {
+            OnAcquire(since, i);
+            return;
+        }
+        Backoff::Pause();
+    }
+
+    // park, mark as contended
+    uint64_t rounds = spin;
+    while(state.exchange(2, std::memory_order_acquire) != 0) {
+        Wait(2);
+        ++rounds;
+    }
+    OnAcquire(since, rounds);
+}
+
+inline void FutexLock::Unlock() {
+    OnRelease();
+    if(state.exchange(0, std::memory_order_release) == 2) {
+        Wake();
+    }
+}
+
+inline bool FutexLock::TryLock() {
+    uint32_t expected = 0;
+    if(!state.compare_exchange_strong(expected, 1, std::memory_order_acquire, std::memory_order_relaxed)) {
+        return false;
+    }
+    OnAcquire(Now(), 0);
+    return true;
+}
+
+inline void FutexLock::Wait(uint32_t value) {
+    Futex::Wait(state, value);
+}
+
+inline void FutexLock::Wake() {
+    Futex::Wake(state);
+}
+
+inline void FutexLock::lock() {
+    Lock();
+}
+
+inline void FutexLock::unlock() {
+    Unlock();
+}
+
+inline bool FutexLock::try_lock() {
+    return TryLock();
+}
+
 template<class Mtx> LockGuard<Mtx>::LockGuard(Mtx& arg): mtx(arg) {
     mtx.lock();
 }
@@ -91,21 +445,29 @@ template<class T, class Mtx> auto TypeLock<T, Mtx>::Locker() -> LockType& {
     return mtx;
 }
 
+template<class T, class Mtx> const Contention::Usage& TypeLock<T, Mtx>::Info() {
+    return mtx.INFO;
+}
+
 template<size_t N, class Mtx> IndexLock<N, Mtx>::IndexLock(): LockGuard<Mtx>(mtx) {}
 
 template<size_t N, class Mtx> auto IndexLock<N, Mtx>::Locker() -> LockType& {
     return mtx;
 }
 
+template<size_t N, class Mtx> const Contention::Usage& IndexLock<N, Mtx>::Info() {
+    return mtx.INFO;
+}
+
 template<class T, class Mtx> Lock<Mtx>::Type TypeLock<T, Mtx>::mtx;
 template<size_t N, class Mtx> Lock<Mtx>::Type IndexLock<N, Mtx>::mtx;
 
-void DisableLock::Lock() {}
+inline void DisableLock::Lock() {}
 
-void DisableLock::Unlock() {}
+inline void DisableLock::Unlock() {}
 
-void DisableLock::lock() {}
+inline void DisableLock::lock() {}
 
-void DisableLock::unlock() {}
+inline void DisableLock::unlock() {}
 
 #endif
\ No newline at end of file
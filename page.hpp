@@ -0,0 +1,96 @@
+#ifndef LWE_UTILITIES_PAGE_HPP
+#define LWE_UTILITIES_PAGE_HPP
+
+#include <cstdint>
+#include <new>
+
+#ifdef _WIN32
+#    include <windows.h>
+#else
+#    include <sys/mman.h>
+#    include <unistd.h>
+#endif
+
+#include "config.h"
+#include "macro.h"
+
+/*
+    segment backing store for Allocator
+
+    HeapProvider           : aligned operator new (default)
+    MapProvider<POPULATE>  : anonymous mmap / VirtualAlloc
+    HugeProvider<POPULATE> : MAP_HUGETLB, fallback to madvise(MADV_HUGEPAGE)
+                             size and alignment are rounded up to 2 MiB
+
+    POPULATE: fault every page in on allocation (MAP_POPULATE, touch on other OS)
+    alignment larger than a page is made by over-mapping and trimming
+
+    use
+
+    Allocator<Block<4096>, SpinLock, 512, 8, Linked, HugeProvider<true>> pool;
+    pool.Expand(64); // 2 MiB pages, faulted in now
+
+    provider
+    - static void* Allocate(size_t size, size_t align): nullptr on failure
+    - static void  Free(void*, size_t size, size_t align)
+    - static constexpr bool DECOMMIT: false, below are not used
+
+    - static size_t Granularity()          : decommit unit
+    - static void   Decommit(void*, size_t): drop pages, keep address range (range is aligned)
+    - static void   Commit(void*, size_t)  : before reuse of decommitted range
+*/
+
+struct HeapProvider {
+    static constexpr bool DECOMMIT = false;
+
+    static void* Allocate(size_t, size_t);
+    static void  Free(void*, size_t, size_t);
+};
+
+template<bool POPULATE = false> struct MapProvider {
+    static constexpr bool DECOMMIT = true;
+
+    static void* Allocate(size_t, size_t);
+    static void  Free(void*, size_t, size_t);
+
+    static size_t Granularity();
+    static void   Decommit(void*, size_t);
+    static void   Commit(void*, size_t);
+};
+
+template<bool POPULATE = false> struct HugeProvider {
+    static constexpr size_t PAGE_SIZE = EConfig::MEMORY_HUGE_PAGE_DEFAULT;
+    static constexpr bool   DECOMMIT  = true;
+
+    static void* Allocate(size_t, size_t);
+    static void  Free(void*, size_t, size_t);
+
+    static size_t Granularity();
+    static void   Decommit(void*, size_t);
+    static void   Commit(void*, size_t);
+
+private:
+    static constexpr size_t Round(size_t);
+};
+
+/*
+    os page functions
+*/
+struct Page {
+    NO_INSTANTIABLE(Page);
+
+public:
+    static size_t Size();
+
+public:
+    static void* Map(size_t, size_t, bool populate = false, bool huge = false); // nullptr on failure
+    static void  Unmap(void*, size_t, size_t);
+    static void  Touch(void*, size_t);
+
+public:
+    static void Decommit(void*, size_t); // MADV_FREE, MADV_DONTNEED or MEM_DECOMMIT
+    static void Commit(void*, size_t);   // MEM_COMMIT, nothing on posix
+};
+
+#include "page.ipp"
+#endif
@@ -0,0 +1,211 @@
+#include "page.hpp"
+
+#ifdef LWE_UTILITIES_PAGE_HPP
+
+inline void* HeapProvider::Allocate(size_t size, size_t align) {
+    return ::operator new(size, std::align_val_t(align), std::nothrow);
+}
+
+inline void HeapProvider::Free(void* ptr, size_t, size_t align) {
+    ::operator delete(ptr, std::align_val_t(align));
+}
+
+template<bool POPULATE> void* MapProvider<POPULATE>::Allocate(size_t size, size_t align) {
+    return Page::Map(size, align, POPULATE);
+}
+
+template<bool POPULATE> void MapProvider<POPULATE>::Free(void* ptr, size_t size, size_t align) {
+    Page::Unmap(ptr, size, align);
+}
+
+template<bool POPULATE> size_t MapProvider<POPULATE>::Granularity() {
+    return Page::Size();
+}
+
+template<bool POPULATE> void MapProvider<POPULATE>::Decommit(void* ptr, size_t size) {
+    Page::Decommit(ptr, size);
+}
+
+template<bool POPULATE> void MapProvider<POPULATE>::Commit(void* ptr, size_t size) {
+    Page::Commit(ptr, size);
+    if constexpr(POPULATE) Page::Touch(ptr, size);
+}
+
+template<bool POPULATE> constexpr size_t HugeProvider<POPULATE>::Round(size_t size) {
+    return (size + PAGE_SIZE - 1) & ~(PAGE_SIZE - 1);
+}
+
+template<bool POPULATE> void* HugeProvider<POPULATE>::Allocate(size_t size, size_t align) {
+    return Page::Map(Round(size), align < PAGE_SIZE ? PAGE_SIZE : align, POPULATE, true);
+}
+
+template<bool POPULATE> void HugeProvider<POPULATE>::Free(void* ptr, size_t size, size_t align) {
+    Page::Unmap(ptr, Round(size), align < PAGE_SIZE ? PAGE_SIZE : align);
+}
+
+template<bool POPULATE> size_t HugeProvider<POPULATE>::Granularity() {
+    return PAGE_SIZE;
+}
+
+template<bool POPULATE> void HugeProvider<POPULATE>::Decommit(void* ptr, size_t size) {
+    Page::Decommit(ptr, size);
+}
+
+template<bool POPULATE> void HugeProvider<POPULATE>::Commit(void* ptr, size_t size) {
+    Page::Commit(ptr, size);
+    if constexpr(POPULATE) Page::Touch(ptr, size);
+}
+
+#ifdef _WIN32
+
+inline size_t Page::Size() {
+    SYSTEM_INFO info;
+    GetSystemInfo(&info);
+    return info.dwAllocationGranularity;
+}
+
+inline void* Page::Map(size_t size, size_t align, bool populate, bool huge) {
+    DWORD type = MEM_RESERVE | MEM_COMMIT;
+    void* ptr  = nullptr;
+
+    // needs SeLockMemoryPrivilege, fallback to normal page
+    if(huge) {
+        ptr = VirtualAlloc(nullptr, size, type | MEM_LARGE_PAGES, PAGE_READWRITE);
+        if(ptr && reinterpret_cast<uintptr_t>(ptr) % align != 0) {
+            VirtualFree(ptr, 0, MEM_RELEASE);
+            ptr = nullptr;
+        }
+    }
+
+    if(!ptr) {
+        if(align <= Size()) {
+            ptr = VirtualAlloc(nullptr, size, type, PAGE_READWRITE);
+        }
+
+        // reserve larger, release, then take the aligned part
+        else for(int retry = 0; retry < 8 && !ptr; ++retry) {
+            void* base = VirtualAlloc(nullptr, size + align, MEM_RESERVE, PAGE_NOACCESS);
+            if(!base) {
+                return nullptr;
+            }
+            uintptr_t aligned = (reinterpret_cast<uintptr_t>(base) + align - 1) & ~(align - 1);
+            VirtualFree(base, 0, MEM_RELEASE);
+            ptr = VirtualAlloc(reinterpret_cast<void*>(aligned), size, type, PAGE_READWRITE);
+        }
+    }
+
+    if(ptr && populate) {
+        Touch(ptr, size);
+    }
+    return ptr;
+}
+
+inline void Page::Unmap(void* ptr, size_t, size_t) {
+    VirtualFree(ptr, 0, MEM_RELEASE);
+}
+
+inline void Page::Decommit(void* ptr, size_t size) {
+    VirtualFree(ptr, size, MEM_DECOMMIT);
+}
+
+inline void Page::Commit(void* ptr, size_t size) {
+    VirtualAlloc(ptr, size, MEM_COMMIT, PAGE_READWRITE);
+}
+
+#else
+
+inline size_t Page::Size() {
+    static const size_t size = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+    return size;
+}
+
+inline void* Page::Map(size_t size, size_t align, bool populate, bool huge) {
+    constexpr int    PROTECT = PROT_READ | PROT_WRITE;
+    constexpr int    FLAGS   = MAP_PRIVATE | MAP_ANONYMOUS;
+    constexpr size_t HUGE    = EConfig::MEMORY_HUGE_PAGE_DEFAULT;
+
+    int prefault = 0;
+#    ifdef MAP_POPULATE
+    if(populate) prefault = MAP_POPULATE;
+#    endif
+
+    size = (size + Size() - 1) & ~(Size() - 1);
+
+#    ifdef MAP_HUGETLB
+    // reserved huge page, aligned by kernel
+    if(huge && align <= HUGE) {
+        void* ptr = mmap(nullptr, size, PROTECT, FLAGS | MAP_HUGETLB | prefault, -1, 0);
+        if(ptr != MAP_FAILED) {
+            return ptr;
+        }
+    }
+#    endif
+
+    // transparent huge page needs aligned range
+    if(huge && align < HUGE) {
+        align = HUGE;
+    }
+
+    if(align <= Size()) {
+        void* ptr = mmap(nullptr, size, PROTECT, FLAGS | prefault, -1, 0);
+        return ptr == MAP_FAILED ? nullptr : ptr;
+    }
+
+    // over-map, then trim head and tail
+    size_t over = size + align;
+    void*  base = mmap(nullptr, over, PROTECT, FLAGS, -1, 0);
+    if(base == MAP_FAILED) {
+        return nullptr;
+    }
+
+    uintptr_t begin   = reinterpret_cast<uintptr_t>(base);
+    uintptr_t aligned = (begin + align - 1) & ~(align - 1);
+    uintptr_t end     = aligned + size;
+
+    if(aligned != begin) {
+        munmap(base, aligned - begin);
+    }
+    if(end != begin + over) {
+        munmap(reinterpret_cast<void*>(end), begin + over - end);
+    }
+
+    void* ptr = reinterpret_cast<void*>(aligned);
+
+#    ifdef MADV_HUGEPAGE
+    if(huge) {
+        madvise(ptr, size, MADV_HUGEPAGE);
+    }
+#    endif
+
+    // after madvise, fault as huge page
+    if(populate) {
+        Touch(ptr, size);
+    }
+    return ptr;
+}
+
+inline void Page::Unmap(void* ptr, size_t size, size_t) {
+    munmap(ptr, size);
+}
+
+inline void Page::Decommit(void* ptr, size_t size) {
+#    ifdef MADV_FREE
+    if(madvise(ptr, size, MADV_FREE) == 0) {
+        return;
+    }
+#    endif
+    madvise(ptr, size, MADV_DONTNEED); // hugetlb, old kernel
+}
+
+inline void Page::Commit(void*, size_t) {}
+
+#endif
+
+inline void Page::Touch(void* ptr, size_t size) {
+    constexpr size_t PAGE = 4096; // smallest page
+    for(size_t offset = 0; offset < size; offset += PAGE) {
+        static_cast<volatile uint8_t*>(ptr)[offset] = 0;
+    }
+}
+
+#endif
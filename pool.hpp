@@ -2,9 +2,15 @@
 #define LWE_POOL_HPP
 
 #include <algorithm>
+#include <iterator>
+#include <span>
+#include <vector>
 
 #include "allocator.hpp"
+#include "executor.hpp"
 #include "id.hpp"
+#include "sparseset.hpp"
+#include "trace.hpp"
 
 template <typename T, size_t POOL_CHUNK_COUNT = EConfig::MEMORY_ALLOCATE_DEFAULT,
           size_t POOL_ALIGNMENT = EConfig::MEMORY_ALIGNMENT_DEFAULT>
@@ -14,15 +20,16 @@ class Pool {
     };
 
 public:
-    using Allocator = Allocator<Allocate, void, POOL_CHUNK_COUNT, POOL_ALIGNMENT>;
-    using Table     = std::vector<ID>;
-    using Indexer   = std::unordered_map<ID, size_t, ID::Hash>;
+    using Allocator = ::Allocator<Allocate, void, POOL_CHUNK_COUNT, POOL_ALIGNMENT>;
+    using Table     = SparseSet::Table;
     using UniqueID  = UID<T>;
 
 private:
     struct Item {
         template <typename Arg> void OnCreate(Arg&&);
+        template <typename Arg> void OnCreate(T*, Arg&&); // allocated
         void                         OnRelease();
+        T*                           OnDestroy();         // not deallocated
 
         T*       instance = nullptr;
         UniqueID id       = UniqueID::Unassigned();
@@ -30,14 +37,14 @@ private:
     };
 
 private:
-    struct Converter {
+    /*
+        sparse set, see sparseset.hpp
+    */
+    struct Converter: SparseSet {
         size_t operator()(ID);           // push
         ID     operator()(size_t);       // pop
         size_t operator[](ID) const;     // get
         ID     operator[](size_t) const; // get
-
-        Table   table;
-        Indexer indexer;
     } converter;
 
 public:
@@ -68,11 +75,21 @@ public:
     public:
         template <typename Arg> static ID Insert(Arg&&); // allocated
         static bool                       Erase(ID);     // deallocate
+
+        template <typename Input> static std::vector<ID> InsertRange(Input, Input); // one lock
+        static size_t                                    EraseRange(std::span<const ID>);
         static T*                         Find(ID);      // get
         static void                       Clear();       // clear no onwer instance
+        static void                       Reserve(size_t, bool touch = true); // allocator, container, IDs for N
         static Iterator                   Begin();
         static Iterator                   End();
 
+        // every live instance, container split across the executor, no Insert / Erase meanwhile
+        template <typename F>
+        static void ParallelForEach(F&&, size_t grain = EConfig::EXECUTOR_GRAIN_DEFAULT, Executor& = Executor::Instance());
+        template <typename R, typename F, typename Join>
+        static R ParallelReduce(R, F&&, Join&&, size_t grain = EConfig::EXECUTOR_GRAIN_DEFAULT, Executor& = Executor::Instance());
+
     private:
         static Item* Search(ID);    // get item, null: not found
     };
@@ -103,6 +120,10 @@ public:
     template <typename Arg> ID Insert(Arg&&); // insert
     size_t                     Take(ID);      // set ownership
 
+    template <typename Input> std::vector<ID> InsertRange(Input, Input); // bulk insert
+
+    void Reserve(size_t, bool touch = true); // Global::Reserve, then this pool's tables
+
 public:
     bool Erase(ID); // erase
     bool Lost(ID);  // reset ownership
@@ -120,6 +141,13 @@ public:
     Iterator Begin();
     Iterator End();
 
+public:
+    // f(T&) / f(T&) -> R, Converter::table split across the executor, no Insert / Erase meanwhile
+    template <typename F>
+    void ParallelForEach(F&&, size_t grain = EConfig::EXECUTOR_GRAIN_DEFAULT, Executor& = Executor::Instance());
+    template <typename R, typename F, typename Join>
+    R ParallelReduce(R, F&&, Join&&, size_t grain = EConfig::EXECUTOR_GRAIN_DEFAULT, Executor& = Executor::Instance());
+
 public:
     T* operator[](ID);
     T* operator[](size_t);
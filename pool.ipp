@@ -8,7 +8,13 @@ std::vector<typename Pool<T, N, A>::Item> Pool<T, N, A>::container;
 template <typename T, size_t N, size_t A>
 template <typename Arg>
 void Pool<T, N, A>::Item::OnCreate(Arg&& arg) {
-    instance = allocator.Allocate<T>();
+    OnCreate(allocator.template Allocate<T>(), arg);
+}
+
+template <typename T, size_t N, size_t A>
+template <typename Arg>
+void Pool<T, N, A>::Item::OnCreate(T* allocated, Arg&& arg) {
+    instance = allocated;
     new (instance) T(arg);
     id.Generate();
 
@@ -16,11 +22,15 @@ void Pool<T, N, A>::Item::OnCreate(Arg&& arg) {
 }
 
 template <typename T, size_t N, size_t A> void Pool<T, N, A>::Item::OnRelease() {
+    Pool::allocator.Deallocate(OnDestroy());
+}
+
+template <typename T, size_t N, size_t A> T* Pool<T, N, A>::Item::OnDestroy() {
     id.Release();
     instance->~T();
-    Pool::allocator.Deallocate(instance);
 
     ref = 0;
+    return instance;
 }
 
 template <typename T, size_t N, size_t A> Pool<T, N, A>::~Pool() { Clear(); }
@@ -33,14 +43,29 @@ ID Pool<T, N, A>::Insert(Arg&& arg) {
     return id;
 }
 
+template <typename T, size_t N, size_t A>
+template <typename Input>
+std::vector<ID> Pool<T, N, A>::InsertRange(Input first, Input last) {
+    std::vector<ID> ids = Global::InsertRange(first, last);
+    for (ID id : ids) {
+        Take(id);
+    }
+    return ids;
+}
+
+template <typename T, size_t N, size_t A> void Pool<T, N, A>::Reserve(size_t count, bool touch) {
+    Global::Reserve(count, touch);
+    converter.Reserve(container.size());
+}
+
 template <typename T, size_t N, size_t A> size_t Pool<T, N, A>::Take(ID id) {
     Item* item = Global::Search(id);
-    if (!item || item->id == ECode::INVALID_ID) {
+    if (!item) {
         return ECode::INVALID_INDEX;
     }
 
     size_t index = converter(id); // insert
-    if (index != ECode::INVALID_INDEX) {
+    if (index != size_t(ECode::INVALID_INDEX)) {
         ++item->ref; // counting
     }
     return index;
@@ -48,7 +73,7 @@ template <typename T, size_t N, size_t A> size_t Pool<T, N, A>::Take(ID id) {
 
 template <typename T, size_t N, size_t A> bool Pool<T, N, A>::Erase(ID id) {
     if (Lost(id)) {
-        if (container[id].ref == 0) {
+        if (container[id.Index()].ref == 0) {
             return Global::Erase(id);
         }
     }
@@ -57,12 +82,12 @@ template <typename T, size_t N, size_t A> bool Pool<T, N, A>::Erase(ID id) {
 
 template <typename T, size_t N, size_t A> bool Pool<T, N, A>::Lost(ID id) {
     Item* item = Global::Search(id);
-    if (!item || item->id == ECode::INVALID_ID) {
+    if (!item) {
         return false;
     }
 
     size_t index = converter[id];
-    if (item && converter(index) != ECode::INVALID_ID) {
+    if (converter(index) != ECode::INVALID_ID) {
         --item->ref;
         return true;
     }
@@ -87,7 +112,7 @@ template <typename T, size_t N, size_t A> void Pool<T, N, A>::Clear() {
 
 template <typename T, size_t N, size_t A> T* Pool<T, N, A>::Find(ID id) {
     Item* item = Global::Search(id);
-    if (item && item->id && converter[id] != ECode::INVALID_INDEX) {
+    if (item && converter[id] != size_t(ECode::INVALID_INDEX)) {
         return item->instance;
     }
     return nullptr;
@@ -119,6 +144,28 @@ auto Pool<T, POOL_CHUNK_COUNT, POOL_ALIGNMENT>::End() -> Iterator {
     return Iterator(this, Size());
 }
 
+template <typename T, size_t N, size_t A>
+template <typename F>
+void Pool<T, N, A>::ParallelForEach(F&& f, size_t grain, Executor& executor) {
+    executor.For(0, Size(), grain, [&](size_t first, size_t last) {
+        for (size_t i = first; i < last; ++i) {
+            f(*container[converter.table[i].Index()].instance);
+        }
+    });
+}
+
+template <typename T, size_t N, size_t A>
+template <typename R, typename F, typename Join>
+R Pool<T, N, A>::ParallelReduce(R init, F&& f, Join&& join, size_t grain, Executor& executor) {
+    return executor.Reduce<R>(0, Size(), grain, std::move(init), [&](size_t first, size_t last) {
+        R value = f(*container[converter.table[first].Index()].instance);
+        for (size_t i = first + 1; i < last; ++i) {
+            value = join(std::move(value), f(*container[converter.table[i].Index()].instance));
+        }
+        return value;
+    }, join);
+}
+
 template <typename T, size_t N, size_t A> T* Pool<T, N, A>::operator[](ID id) {
     Item* item = Global::Search(id);
     if (!item || converter[id] == ECode::INVALID_INDEX) {
@@ -129,10 +176,10 @@ template <typename T, size_t N, size_t A> T* Pool<T, N, A>::operator[](ID id) {
 
 template <typename T, size_t N, size_t A> T* Pool<T, N, A>::operator[](size_t index) {
     ID id = converter[index];
-    if (id == ECode::INVALID_ID || Search(id) == nullptr) {
+    if (id == ECode::INVALID_ID || Global::Search(id) == nullptr) {
         return nullptr;
     }
-    return container[id].instance;
+    return container[id.Index()].instance;
 }
 
 /*
@@ -147,15 +194,18 @@ ID Pool<T, N, A>::Global::Insert(Arg&& arg) {
         return ID::Invalid();
     }
 
-    while (next >= container.size()) {
-        if (allocator.Expand(1) == 0) {
+    // geometric, as many segments as there are
+    while (next.Index() >= container.size()) {
+        size_t blocks = allocator.INFO.block.total;
+        if (allocator.Expand(blocks ? blocks : 1) == 0) {
             return ID::Invalid(); // failed call malloc()
         }
         container.resize(1 + allocator.INFO.chunk.total);
     }
 
-    Item* item = Search(next);
+    Item* item = &container[next.Index()]; // empty slot of the next ID
     item->OnCreate(arg);
+    Trace::Write(Trace::INSERT, item->id, sizeof(T));
     return item->id;
 }
 
@@ -164,17 +214,70 @@ template <typename T, size_t N, size_t A> bool Pool<T, N, A>::Global::Erase(ID i
     if (!item) {
         return false;
     }
+    Trace::Write(Trace::ERASE, id, sizeof(T));
     item->OnRelease();
 
     return true;
 }
 
+template <typename T, size_t N, size_t A>
+template <typename Input>
+std::vector<ID> Pool<T, N, A>::Global::InsertRange(Input first, Input last) {
+    std::vector<T*> instances(std::distance(first, last));
+    size_t          allocated = allocator.AllocateBatch(instances.size(), instances.data());
+
+    std::vector<ID> ids;
+    ids.reserve(allocated);
+
+    for (size_t i = 0; i < allocated; ++i, ++first) {
+        ID next = UniqueID::Preview();
+        if (next == ECode::INVALID_ID) {
+            allocator.template DeallocateBatch<T>({ instances.data() + i, allocated - i });
+            break;
+        }
+
+        if (next.Index() >= container.size()) {
+            size_t total = allocator.INFO.chunk.total;
+            container.resize(1 + (next.Index() < total ? total : next.Index()));
+        }
+
+        Item* item = &container[next.Index()]; // empty slot of the next ID
+        item->OnCreate(instances[i], *first);
+        ids.push_back(item->id);
+        Trace::Write(Trace::INSERT, item->id, sizeof(T));
+    }
+    return ids;
+}
+
+template <typename T, size_t N, size_t A> size_t Pool<T, N, A>::Global::EraseRange(std::span<const ID> ids) {
+    std::vector<T*> instances;
+    instances.reserve(ids.size());
+
+    for (ID id : ids) {
+        Item* item = Search(id);
+        if (item) {
+            Trace::Write(Trace::ERASE, id, sizeof(T));
+            instances.push_back(item->OnDestroy());
+        }
+    }
+
+    allocator.template DeallocateBatch<T>(instances);
+    return instances.size();
+}
+
+template <typename T, size_t N, size_t A> void Pool<T, N, A>::Global::Reserve(size_t count, bool touch) {
+    allocator.Reserve(count, touch);
+    UniqueID::Reserve(count);
+
+    size_t size = 1 + allocator.INFO.chunk.total;
+    if (container.size() < size) {
+        container.resize(size);
+    }
+}
+
 template <typename T, size_t N, size_t A> T* Pool<T, N, A>::Global::Find(ID id) {
     Item* item = Search(id);
-    if (item && item->id) {
-        return item->instance;
-    }
-    return nullptr;
+    return item ? item->instance : nullptr;
 }
 
 
@@ -192,11 +295,52 @@ template <typename T, size_t N, size_t A> void Pool<T, N, A>::Global::Clear() {
     allocator.Reduce();
 }
 
+template <typename T, size_t N, size_t A>
+template <typename F>
+void Pool<T, N, A>::Global::ParallelForEach(F&& f, size_t grain, Executor& executor) {
+    executor.For(1, container.size(), grain, [&](size_t first, size_t last) {
+        for (size_t i = first; i < last; ++i) {
+            if (container[i].id != ECode::INVALID_ID) {
+                f(*container[i].instance);
+            }
+        }
+    });
+}
+
+template <typename T, size_t N, size_t A>
+template <typename R, typename F, typename Join>
+R Pool<T, N, A>::Global::ParallelReduce(R init, F&& f, Join&& join, size_t grain, Executor& executor) {
+    // chunk of holes only: nothing to join
+    return executor.Reduce<std::optional<R>>(1, container.size(), grain, std::optional<R>(std::move(init)),
+        [&](size_t first, size_t last) {
+            std::optional<R> value;
+            for (size_t i = first; i < last; ++i) {
+                if (container[i].id != ECode::INVALID_ID) {
+                    R mapped = f(*container[i].instance);
+                    value    = value ? join(std::move(*value), std::move(mapped)) : std::move(mapped);
+                }
+            }
+            return value;
+        },
+        [&](std::optional<R> a, std::optional<R> b) {
+            if (!a) return b;
+            if (!b) return a;
+            return std::optional<R>(join(std::move(*a), std::move(*b)));
+        }).value();
+}
+
 template <typename T, size_t N, size_t A> auto Pool<T, N, A>::Global::Search(ID id) -> Item* {
-    if (id == ECode::INVALID_ID || id >= container.size()) {
+    size_t index = id.Index();
+    if (index == ECode::INVALID_ID || index >= container.size()) {
+        return nullptr;
+    }
+
+    // empty slot or stale, slot erased or reused by a newer generation
+    Item* item = &container[index];
+    if (ID(item->id) != id) {
         return nullptr;
     }
-    return &container[id];
+    return item;
 }
 
 
@@ -205,31 +349,29 @@ template <typename T, size_t N, size_t A> auto Pool<T, N, A>::Global::Search(ID
 */
 
 template <typename T, size_t N, size_t A> size_t Pool<T, N, A>::Converter::operator()(ID id) {
-    size_t last = table.size();
-
-    Indexer::const_iterator itr = indexer.find(id);
+    size_t& slot = Slot(id);
 
     // not exist or deleted id
-    if (itr == indexer.end() || itr->second == ECode::INVALID_INDEX) {
+    if (slot == size_t(ECode::INVALID_INDEX)) {
+        slot = table.size();
         table.push_back(id); // new
-        indexer[id] = last;
-        return last;
+        return slot;
+    }
+
+    // older generation erased without Lost, reuse its place
+    if (table[slot] != id) {
+        table[slot] = id;
+        return slot;
     }
     return ECode::INVALID_INDEX; // duplicated
 }
 
 template <typename T, size_t N, size_t A> ID Pool<T, N, A>::Converter::operator()(size_t idx) {
-    size_t last = table.size() - 1;
-
     ID deleteID = operator[](idx);
-    ID lastID = operator[](last);
 
     // id exist
     if (deleteID != ECode::INVALID_ID) {
-        table[idx] = table[last];          // move
-        indexer[lastID] = idx;                  // move
-        indexer[deleteID] = ECode::INVALID_INDEX; // ref delete
-        table.pop_back();                         // delete
+        Remove(idx); // last moves into idx
     }
     return deleteID;
 }
@@ -243,11 +385,7 @@ ID Pool<T, N, A>::Converter::operator[](size_t index) const {
 }
 
 template <typename T, size_t N, size_t A> size_t Pool<T, N, A>::Converter::operator[](ID id) const {
-    Indexer::const_iterator itr = indexer.find(id);
-    if (itr == indexer.end()) {
-        return ECode::INVALID_INDEX;
-    }
-    return itr->second;
+    return Find(id);
 }
 
 
@@ -291,11 +429,11 @@ bool Pool<T, N, A>::Iterator::operator!=(const Iterator& ref) const {
 }
 
 template <typename T, size_t N, size_t A> T* Pool<T, N, A>::Iterator::operator->() {
-    return container[ref->converter[index]].instance;
+    return container[ID(ref->converter[index]).Index()].instance;
 }
 
 template <typename T, size_t N, size_t A> T& Pool<T, N, A>::Iterator::operator*() {
-    return *container[ref->converter[index]].instance;
+    return *container[ID(ref->converter[index]).Index()].instance;
 }
 
 template <typename T, size_t N, size_t A> Pool<T, N, A>::Iterator::operator ID() const {
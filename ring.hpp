@@ -0,0 +1,193 @@
+#ifndef LWE_UTILITIES_RING_HPP
+#define LWE_UTILITIES_RING_HPP
+
+#include <atomic>
+#include <climits>
+#include <cstdint>
+#include <new>
+#include <span>
+#include <type_traits>
+#include <utility>
+
+#include "config.h"
+#include "lock.hpp"
+#include "macro.h"
+
+/*
+    bounded ring queues, ownership moved through the ring
+    - T: Buffer (move = pointer steal), pool chunk pointer, any movable type
+    - CAPACITY: power of 2, slots inline, no allocation after construction
+    - head and tail on their own cache lines
+
+    SPSCRing
+    - one producer thread, one consumer thread
+    - each side keeps a copy of the other index, reloaded only when it looks full / empty
+
+    MPMCRing
+    - Vyukov bounded queue, sequence number per cell
+    - one CAS per push / pop, batch: one CAS per run of ready cells
+
+    TryPush / TryPop
+    - never wait, false or count moved
+    - batch: moved in order from the front of the span, rest of the span untouched
+
+    BLOCKING (optional)
+    - Push / Pop wait, spin LOCK_PARK_SPIN_DEFAULT times, then futex (std::atomic wait off Linux)
+    - every push / pop wakes the other side, one fence when nobody is parked
+    - Close(): after the last Push, waiters return, Push fails, Pop drains what is left then fails
+
+    destruction: items left are destroyed, a raw pointer is not freed
+
+    use
+
+    MPMCRing<Packet, 1024, true> inbound; // io threads -> workers
+
+    // io thread
+    Packet packet{ Packet::Uninitialized() };
+    packet.Resize(recv(socket, static_cast<char*>(packet), packet.Capacity(), 0));
+    inbound.Push(std::move(packet)); // no lock, no allocation
+
+    // worker
+    Packet work[32];
+    while(size_t n = inbound.Pop(work)) {
+        Handle(work, n);
+    }
+
+    // shutdown
+    inbound.Close();
+
+    SPSCRing<Block<64>*> chunks; // pool chunks from one thread to another
+    chunks.TryPush(allocator.Allocate());
+*/
+
+/*
+    futex event count, waiters park until a predicate holds
+*/
+class Parking {
+public:
+    NO_COPYABLE(Parking);
+    NO_MOVABLE(Parking);
+    Parking() = default;
+
+public:
+    template<class F> void Wait(F&& ready); // spin, then park until ready()
+    void                   Notify(uint32_t count = 1);
+    void                   NotifyAll();
+
+private:
+    void Park(uint32_t);
+    void Wake(uint32_t);
+
+private:
+    std::atomic<uint32_t> epoch    = 0; // futex word, changed on every wake
+    std::atomic<uint32_t> sleepers = 0;
+};
+
+template<class T, size_t CAPACITY = EConfig::RING_CAPACITY_DEFAULT, bool BLOCKING = false> class SPSCRing {
+    static_assert(CAPACITY && (CAPACITY & (CAPACITY - 1)) == 0, "CAPACITY must be power of 2");
+    static_assert(std::is_nothrow_move_constructible_v<T>, "T must be nothrow movable");
+
+public:
+    NO_COPYABLE(SPSCRing);
+    NO_MOVABLE(SPSCRing);
+    SPSCRing() = default;
+    ~SPSCRing();
+
+public:
+    static constexpr size_t Capacity();
+
+public:
+    bool   TryPush(T&&);
+    bool   TryPop(T&);
+    size_t TryPush(std::span<T>); // moved from
+    size_t TryPop(std::span<T>);
+
+public:
+    bool   Push(T&&);            // BLOCKING, false: closed
+    bool   Pop(T&);              // BLOCKING, false: closed and empty
+    size_t Push(std::span<T>);   // BLOCKING, all unless closed
+    size_t Pop(std::span<T>);    // BLOCKING, one at least, 0: closed and empty
+    void   Close();
+    bool   Closed() const;
+
+public:
+    size_t Size() const; // approximate while used
+    bool   Empty() const;
+
+private:
+    T* Slot(size_t);
+
+private:
+    static constexpr size_t MASK = CAPACITY - 1;
+
+private:
+    alignas(EConfig::MEMORY_CACHE_LINE_DEFAULT) std::atomic<size_t> tail = 0;
+    size_t                                                          front = 0; // producer copy of head
+
+    alignas(EConfig::MEMORY_CACHE_LINE_DEFAULT) std::atomic<size_t> head = 0;
+    size_t                                                          back = 0; // consumer copy of tail
+
+    alignas(EConfig::MEMORY_CACHE_LINE_DEFAULT) Parking readable; // consumers park
+    alignas(EConfig::MEMORY_CACHE_LINE_DEFAULT) Parking writable; // producers park
+    std::atomic_bool                                    closed = false;
+
+    alignas(EConfig::MEMORY_CACHE_LINE_DEFAULT) alignas(T) unsigned char storage[CAPACITY][sizeof(T)];
+};
+
+template<class T, size_t CAPACITY = EConfig::RING_CAPACITY_DEFAULT, bool BLOCKING = false> class MPMCRing {
+    static_assert(CAPACITY && (CAPACITY & (CAPACITY - 1)) == 0, "CAPACITY must be power of 2");
+    static_assert(std::is_nothrow_move_constructible_v<T>, "T must be nothrow movable");
+
+public:
+    NO_COPYABLE(MPMCRing);
+    NO_MOVABLE(MPMCRing);
+    MPMCRing();
+    ~MPMCRing();
+
+public:
+    static constexpr size_t Capacity();
+
+public:
+    bool   TryPush(T&&);
+    bool   TryPop(T&);
+    size_t TryPush(std::span<T>); // moved from
+    size_t TryPop(std::span<T>);
+
+public:
+    bool   Push(T&&);            // BLOCKING, false: closed
+    bool   Pop(T&);              // BLOCKING, false: closed and empty
+    size_t Push(std::span<T>);   // BLOCKING, all unless closed
+    size_t Pop(std::span<T>);    // BLOCKING, one at least, 0: closed and empty
+    void   Close();
+    bool   Closed() const;
+
+public:
+    size_t Size() const; // approximate while used
+    bool   Empty() const;
+
+private:
+    struct Cell {
+        std::atomic<size_t>      sequence; // position: free, position + 1: filled
+        alignas(T) unsigned char storage[sizeof(T)];
+    };
+
+private:
+    T*     Value(Cell&);
+    size_t Claim(std::atomic<size_t>&, size_t& count, size_t filled); // first position of a run, count: wanted in, claimed out
+
+private:
+    static constexpr size_t MASK = CAPACITY - 1;
+
+private:
+    alignas(EConfig::MEMORY_CACHE_LINE_DEFAULT) std::atomic<size_t> tail = 0;
+    alignas(EConfig::MEMORY_CACHE_LINE_DEFAULT) std::atomic<size_t> head = 0;
+
+    alignas(EConfig::MEMORY_CACHE_LINE_DEFAULT) Parking readable; // consumers park
+    alignas(EConfig::MEMORY_CACHE_LINE_DEFAULT) Parking writable; // producers park
+    std::atomic_bool                                    closed = false;
+
+    alignas(EConfig::MEMORY_CACHE_LINE_DEFAULT) Cell cells[CAPACITY];
+};
+
+#include "ring.ipp"
+#endif
@@ -0,0 +1,454 @@
+#include "ring.hpp"
+
+#ifdef LWE_UTILITIES_RING_HPP
+
+/*
+    Parking
+*/
+
+template<class F> void Parking::Wait(F&& ready) {
+    for(int i = 0; i < EConfig::LOCK_PARK_SPIN_DEFAULT; ++i) {
+        if(ready()) {
+            return;
+        }
+        Backoff::Pause();
+    }
+
+    for(;;) {
+        uint32_t seen = epoch.load(std::memory_order_acquire);
+
+        // registered before the check, Notify either sees the sleeper or the waiter sees the change
+        sleepers.fetch_add(1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if(ready()) {
+            sleepers.fetch_sub(1, std::memory_order_relaxed);
+            return;
+        }
+
+        Park(seen);
+        sleepers.fetch_sub(1, std::memory_order_relaxed);
+        if(ready()) {
+            return;
+        }
+    }
+}
+
+inline void Parking::Notify(uint32_t count) {
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if(sleepers.load(std::memory_order_relaxed) == 0) {
+        return;
+    }
+
+    epoch.fetch_add(1, std::memory_order_release);
+    Wake(count);
+}
+
+inline void Parking::NotifyAll() {
+    Notify(INT_MAX);
+}
+
+inline void Parking::Park(uint32_t value) {
+    Futex::Wait(epoch, value);
+}
+
+inline void Parking::Wake(uint32_t count) {
+    Futex::Wake(epoch, count);
+}
+
+/*
+    SPSCRing
+*/
+
+template<class T, size_t CAPACITY, bool BLOCKING> SPSCRing<T, CAPACITY, BLOCKING>::~SPSCRing() {
+    for(size_t i = head.load(std::memory_order_relaxed); i != tail.load(std::memory_order_relaxed); ++i) {
+        Slot(i)->~T();
+    }
+}
+
+template<class T, size_t CAPACITY, bool BLOCKING> constexpr size_t SPSCRing<T, CAPACITY, BLOCKING>::Capacity() {
+    return CAPACITY;
+}
+
+template<class T, size_t CAPACITY, bool BLOCKING> bool SPSCRing<T, CAPACITY, BLOCKING>::TryPush(T&& value) {
+    size_t last = tail.load(std::memory_order_relaxed);
+
+    // looks full: reload the consumer index
+    if(last - front == CAPACITY) {
+        front = head.load(std::memory_order_acquire);
+        if(last - front == CAPACITY) {
+            return false;
+        }
+    }
+
+    new(Slot(last)) T(std::move(value));
+    tail.store(last + 1, std::memory_order_release);
+
+    if constexpr(BLOCKING) readable.Notify();
+    return true;
+}
+
+template<class T, size_t CAPACITY, bool BLOCKING> bool SPSCRing<T, CAPACITY, BLOCKING>::TryPop(T& value) {
+    size_t first = head.load(std::memory_order_relaxed);
+
+    // looks empty: reload the producer index
+    if(first == back) {
+        back = tail.load(std::memory_order_acquire);
+        if(first == back) {
+            return false;
+        }
+    }
+
+    T* slot = Slot(first);
+    value   = std::move(*slot);
+    slot->~T();
+    head.store(first + 1, std::memory_order_release);
+
+    if constexpr(BLOCKING) writable.Notify();
+    return true;
+}
+
+template<class T, size_t CAPACITY, bool BLOCKING> size_t SPSCRing<T, CAPACITY, BLOCKING>::TryPush(std::span<T> values) {
+    size_t last = tail.load(std::memory_order_relaxed);
+
+    if(CAPACITY - (last - front) < values.size()) {
+        front = head.load(std::memory_order_acquire);
+    }
+
+    size_t count = CAPACITY - (last - front);
+    if(count > values.size()) count = values.size();
+    if(count == 0) {
+        return 0;
+    }
+
+    for(size_t i = 0; i < count; ++i) {
+        new(Slot(last + i)) T(std::move(values[i]));
+    }
+    tail.store(last + count, std::memory_order_release);
+
+    if constexpr(BLOCKING) readable.Notify(uint32_t(count));
+    return count;
+}
+
+template<class T, size_t CAPACITY, bool BLOCKING> size_t SPSCRing<T, CAPACITY, BLOCKING>::TryPop(std::span<T> values) {
+    size_t first = head.load(std::memory_order_relaxed);
+
+    if(back - first < values.size()) {
+        back = tail.load(std::memory_order_acquire);
+    }
+
+    size_t count = back - first;
+    if(count > values.size()) count = values.size();
+    if(count == 0) {
+        return 0;
+    }
+
+    for(size_t i = 0; i < count; ++i) {
+        T* slot   = Slot(first + i);
+        values[i] = std::move(*slot);
+        slot->~T();
+    }
+    head.store(first + count, std::memory_order_release);
+
+    if constexpr(BLOCKING) writable.Notify(uint32_t(count));
+    return count;
+}
+
+template<class T, size_t CAPACITY, bool BLOCKING> bool SPSCRing<T, CAPACITY, BLOCKING>::Push(T&& value) {
+    static_assert(BLOCKING, "Push requires a BLOCKING ring, use TryPush.");
+
+    for(;;) {
+        if(closed.load(std::memory_order_acquire)) {
+            return false;
+        }
+        if(TryPush(std::move(value))) {
+            return true;
+        }
+        writable.Wait([this] { return Size() < CAPACITY || Closed(); });
+    }
+}
+
+template<class T, size_t CAPACITY, bool BLOCKING> bool SPSCRing<T, CAPACITY, BLOCKING>::Pop(T& value) {
+    static_assert(BLOCKING, "Pop requires a BLOCKING ring, use TryPop.");
+
+    for(;;) {
+        if(TryPop(value)) {
+            return true;
+        }
+        if(closed.load(std::memory_order_acquire)) {
+            return TryPop(value);
+        }
+        readable.Wait([this] { return !Empty() || Closed(); });
+    }
+}
+
+template<class T, size_t CAPACITY, bool BLOCKING> size_t SPSCRing<T, CAPACITY, BLOCKING>::Push(std::span<T> values) {
+    static_assert(BLOCKING, "Push requires a BLOCKING ring, use TryPush.");
+
+    size_t done = 0;
+    while(done < values.size()) {
+        if(closed.load(std::memory_order_acquire)) {
+            break;
+        }
+
+        size_t count = TryPush(values.subspan(done));
+        if(count == 0) {
+            writable.Wait([this] { return Size() < CAPACITY || Closed(); });
+        }
+        done += count;
+    }
+    return done;
+}
+
+template<class T, size_t CAPACITY, bool BLOCKING> size_t SPSCRing<T, CAPACITY, BLOCKING>::Pop(std::span<T> values) {
+    static_assert(BLOCKING, "Pop requires a BLOCKING ring, use TryPop.");
+
+    if(values.empty()) {
+        return 0;
+    }
+
+    for(;;) {
+        if(size_t count = TryPop(values)) {
+            return count;
+        }
+        if(closed.load(std::memory_order_acquire)) {
+            return TryPop(values);
+        }
+        readable.Wait([this] { return !Empty() || Closed(); });
+    }
+}
+
+template<class T, size_t CAPACITY, bool BLOCKING> void SPSCRing<T, CAPACITY, BLOCKING>::Close() {
+    closed.store(true, std::memory_order_release);
+    readable.NotifyAll();
+    writable.NotifyAll();
+}
+
+template<class T, size_t CAPACITY, bool BLOCKING> bool SPSCRing<T, CAPACITY, BLOCKING>::Closed() const {
+    return closed.load(std::memory_order_acquire);
+}
+
+template<class T, size_t CAPACITY, bool BLOCKING> size_t SPSCRing<T, CAPACITY, BLOCKING>::Size() const {
+    // head first, tail never behind it
+    size_t first = head.load(std::memory_order_acquire);
+    return tail.load(std::memory_order_acquire) - first;
+}
+
+template<class T, size_t CAPACITY, bool BLOCKING> bool SPSCRing<T, CAPACITY, BLOCKING>::Empty() const {
+    return Size() == 0;
+}
+
+template<class T, size_t CAPACITY, bool BLOCKING> T* SPSCRing<T, CAPACITY, BLOCKING>::Slot(size_t position) {
+    return std::launder(reinterpret_cast<T*>(storage[position & MASK]));
+}
+
+/*
+    MPMCRing
+*/
+
+template<class T, size_t CAPACITY, bool BLOCKING> MPMCRing<T, CAPACITY, BLOCKING>::MPMCRing() {
+    for(size_t i = 0; i < CAPACITY; ++i) {
+        cells[i].sequence.store(i, std::memory_order_relaxed);
+    }
+}
+
+template<class T, size_t CAPACITY, bool BLOCKING> MPMCRing<T, CAPACITY, BLOCKING>::~MPMCRing() {
+    for(size_t i = head.load(std::memory_order_relaxed); i != tail.load(std::memory_order_relaxed); ++i) {
+        Cell& cell = cells[i & MASK];
+        if(cell.sequence.load(std::memory_order_relaxed) == i + 1) {
+            Value(cell)->~T();
+        }
+    }
+}
+
+template<class T, size_t CAPACITY, bool BLOCKING> constexpr size_t MPMCRing<T, CAPACITY, BLOCKING>::Capacity() {
+    return CAPACITY;
+}
+
+template<class T, size_t CAPACITY, bool BLOCKING> bool MPMCRing<T, CAPACITY, BLOCKING>::TryPush(T&& value) {
+    size_t count    = 1;
+    size_t position = Claim(tail, count, 0);
+    if(count == 0) {
+        return false;
+    }
+
+    Cell& cell = cells[position & MASK];
+    new(cell.storage) T(std::move(value));
+    cell.sequence.store(position + 1, std::memory_order_release);
+
+    if constexpr(BLOCKING) readable.Notify();
+    return true;
+}
+
+template<class T, size_t CAPACITY, bool BLOCKING> bool MPMCRing<T, CAPACITY, BLOCKING>::TryPop(T& value) {
+    size_t count    = 1;
+    size_t position = Claim(head, count, 1);
+    if(count == 0) {
+        return false;
+    }
+
+    Cell& cell = cells[position & MASK];
+    T*    slot = Value(cell);
+    value      = std::move(*slot);
+    slot->~T();
+    cell.sequence.store(position + CAPACITY, std::memory_order_release);
+
+    if constexpr(BLOCKING) writable.Notify();
+    return true;
+}
+
+template<class T, size_t CAPACITY, bool BLOCKING> size_t MPMCRing<T, CAPACITY, BLOCKING>::TryPush(std::span<T> values) {
+    size_t count    = values.size() < CAPACITY ? values.size() : CAPACITY;
+    size_t position = count ? Claim(tail, count, 0) : 0;
+
+    // each cell published on its own, consumers start before the run is complete
+    for(size_t i = 0; i < count; ++i) {
+        Cell& cell = cells[(position + i) & MASK];
+        new(cell.storage) T(std::move(values[i]));
+        cell.sequence.store(position + i + 1, std::memory_order_release);
+    }
+
+    if constexpr(BLOCKING) {
+        if(count) readable.Notify(uint32_t(count));
+    }
+    return count;
+}
+
+template<class T, size_t CAPACITY, bool BLOCKING> size_t MPMCRing<T, CAPACITY, BLOCKING>::TryPop(std::span<T> values) {
+    size_t count    = values.size() < CAPACITY ? values.size() : CAPACITY;
+    size_t position = count ? Claim(head, count, 1) : 0;
+
+    for(size_t i = 0; i < count; ++i) {
+        Cell& cell = cells[(position + i) & MASK];
+        T*    slot = Value(cell);
+        values[i]  = std::move(*slot);
+        slot->~T();
+        cell.sequence.store(position + i + CAPACITY, std::memory_order_release);
+    }
+
+    if constexpr(BLOCKING) {
+        if(count) writable.Notify(uint32_t(count));
+    }
+    return count;
+}
+
+template<class T, size_t CAPACITY, bool BLOCKING> bool MPMCRing<T, CAPACITY, BLOCKING>::Push(T&& value) {
+    static_assert(BLOCKING, "Push requires a BLOCKING ring, use TryPush.");
+
+    for(;;) {
+        if(closed.load(std::memory_order_acquire)) {
+            return false;
+        }
+        if(TryPush(std::move(value))) {
+            return true;
+        }
+        writable.Wait([this] { return Size() < CAPACITY || Closed(); });
+    }
+}
+
+template<class T, size_t CAPACITY, bool BLOCKING> bool MPMCRing<T, CAPACITY, BLOCKING>::Pop(T& value) {
+    static_assert(BLOCKING, "Pop requires a BLOCKING ring, use TryPop.");
+
+    for(;;) {
+        if(TryPop(value)) {
+            return true;
+        }
+        if(closed.load(std::memory_order_acquire)) {
+            return TryPop(value);
+        }
+        readable.Wait([this] { return !Empty() || Closed(); });
+    }
+}
+
+template<class T, size_t CAPACITY, bool BLOCKING> size_t MPMCRing<T, CAPACITY, BLOCKING>::Push(std::span<T> values) {
+    static_assert(BLOCKING, "Push requires a BLOCKING ring, use TryPush.");
+
+    size_t done = 0;
+    while(done < values.size()) {
+        if(closed.load(std::memory_order_acquire)) {
+            break;
+        }
+
+        size_t count = TryPush(values.subspan(done));
+        if(count == 0) {
+            writable.Wait([this] { return Size() < CAPACITY || Closed(); });
+        }
+        done += count;
+    }
+    return done;
+}
+
+template<class T, size_t CAPACITY, bool BLOCKING> size_t MPMCRing<T, CAPACITY, BLOCKING>::Pop(std::span<T> values) {
+    static_assert(BLOCKING, "Pop requires a BLOCKING ring, use TryPop.");
+
+    if(values.empty()) {
+        return 0;
+    }
+
+    for(;;) {
+        if(size_t count = TryPop(values)) {
+            return count;
+        }
+        if(closed.load(std::memory_order_acquire)) {
+            return TryPop(values);
+        }
+        readable.Wait([this] { return !Empty() || Closed(); });
+    }
+}
+
+template<class T, size_t CAPACITY, bool BLOCKING> void MPMCRing<T, CAPACITY, BLOCKING>::Close() {
+    closed.store(true, std::memory_order_release);
+    readable.NotifyAll();
+    writable.NotifyAll();
+}
+
+template<class T, size_t CAPACITY, bool BLOCKING> bool MPMCRing<T, CAPACITY, BLOCKING>::Closed() const {
+    return closed.load(std::memory_order_acquire);
+}
+
+template<class T, size_t CAPACITY, bool BLOCKING> size_t MPMCRing<T, CAPACITY, BLOCKING>::Size() const {
+    // positions are claimed before the cell is done, a cell in use counts on both sides
+    size_t first = head.load(std::memory_order_acquire);
+    return tail.load(std::memory_order_acquire) - first;
+}
+
+template<class T, size_t CAPACITY, bool BLOCKING> bool MPMCRing<T, CAPACITY, BLOCKING>::Empty() const {
+    return Size() == 0;
+}
+
+template<class T, size_t CAPACITY, bool BLOCKING> T* MPMCRing<T, CAPACITY, BLOCKING>::Value(Cell& cell) {
+    return std::launder(reinterpret_cast<T*>(cell.storage));
+}
+
+template<class T, size_t CAPACITY, bool BLOCKING>
+size_t MPMCRing<T, CAPACITY, BLOCKING>::Claim(std::atomic<size_t>& index, size_t& count, size_t filled) {
+    size_t position = index.load(std::memory_order_relaxed);
+
+    for(;;) {
+        intptr_t diff = intptr_t(cells[position & MASK].sequence.load(std::memory_order_acquire)) - intptr_t(position + filled);
+
+        // a lap behind: full (push) or empty (pop)
+        if(diff < 0) {
+            count = 0;
+            return position;
+        }
+
+        // taken by another thread
+        if(diff > 0) {
+            position = index.load(std::memory_order_relaxed);
+            continue;
+        }
+
+        // run of ready cells, no other thread changes them before index moves past
+        size_t ready = 1;
+        while(ready < count && cells[(position + ready) & MASK].sequence.load(std::memory_order_acquire) == position + ready + filled) {
+            ++ready;
+        }
+
+        if(index.compare_exchange_weak(position, position + ready, std::memory_order_relaxed, std::memory_order_relaxed)) {
+            count = ready;
+            return position;
+        }
+    }
+}
+
+#endif
@@ -0,0 +1,95 @@
+#ifndef LWE_UTILITIES_SHARDED_HPP
+#define LWE_UTILITIES_SHARDED_HPP
+
+#include <atomic>
+#include <memory>
+#include <thread>
+
+#if defined(__linux__)
+#    include <sched.h>
+#endif
+
+#include "allocator.hpp"
+
+/*
+    sharded allocator
+    - one Allocator per shard, each on its own cache lines (mtx, lists, usage)
+    - Allocate: shard of this thread, a dry shard steals one fully usable segment
+                of up to STEAL other shards (round robin) before Expand
+    - Deallocate: shard of the segment, from any thread
+    - Info(): sum of shards
+
+    shard index
+    - per cpu   : sched_getcpu() % count (Windows: GetCurrentProcessorNumber())
+    - per thread: thread index % count, N threads share a shard if count < threads
+    - per cpu falls back to per thread where cpu number is not available
+
+    use
+
+    ShardedAllocator<Packet> packets;           // hardware_concurrency() shards, per cpu
+    ShardedAllocator<Packet> packets(8, false); // 8 shards, per thread
+
+    Packet* packet = packets.Construct(...);
+    packets.Deconstruct(packet); // any thread
+*/
+template<typename T, class Mtx = SpinLock,
+    size_t COUNT = EConfig::MEMORY_ALLOCATE_DEFAULT,
+    size_t ALIGN = EConfig::MEMORY_ALIGNMENT_DEFAULT,
+    class Layout = Linked, class Provider = HeapProvider>
+class ShardedAllocator {
+public:
+    NO_COPYABLE(ShardedAllocator);
+    NO_MOVABLE(ShardedAllocator);
+
+public:
+    using AllocatorType = Allocator<T, Mtx, COUNT, ALIGN, Layout, Provider>;
+
+    static_assert(!AllocatorType::CACHE_SIZE && !AllocatorType::LOCK_FREE, "Shard must be a locked allocator.");
+
+private:
+    struct alignas(EConfig::MEMORY_CACHE_LINE_DEFAULT) Shard {
+        AllocatorType allocator;
+    };
+
+public:
+    ShardedAllocator(size_t count = 0, bool cpu = true); // 0: hardware concurrency
+
+public:
+    template<typename U = T> U*                   Allocate();
+    template<typename U = T, typename... Args> U* Construct(Args&&...);
+    template<typename U = T> void                 Deconstruct(U* ptr);
+    template<typename U = void> void              Deallocate(U*);
+
+public:
+    size_t Expand(size_t = 1);        // shard of this thread
+    size_t Reduce(size_t = SIZE_MAX); // N of each shard
+    size_t Trim(uint64_t now);
+
+public:
+    void Retain(size_t blocks, size_t bytes = 0); // each shard
+    void Decay(uint64_t ticks);
+
+public:
+    size_t         Count() const;
+    AllocatorType& Local();      // shard of this thread
+    Memory::Usage  Info() const; // sum of shards
+
+private:
+    size_t                Index() const;
+    static AllocatorType* Owner(void*); // shard of chunk
+
+private:
+    static constexpr size_t STEAL = 2; // shards tried by a dry shard, one lock each
+
+private:
+    std::unique_ptr<Shard[]> shards;
+    size_t                   count;
+    bool                     cpu;
+    std::atomic<size_t>      cursor = 0; // round robin start of steal
+
+private:
+    static std::atomic<size_t> sequence; // next thread index
+};
+
+#include "sharded.ipp"
+#endif
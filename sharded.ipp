@@ -0,0 +1,149 @@
+#include "sharded.hpp"
+
+#ifdef LWE_UTILITIES_SHARDED_HPP
+
+template<typename T, class Mtx, size_t COUNT, size_t ALIGN, class Layout, class Provider>
+std::atomic<size_t> ShardedAllocator<T, Mtx, COUNT, ALIGN, Layout, Provider>::sequence = 0;
+
+template<typename T, class Mtx, size_t COUNT, size_t ALIGN, class Layout, class Provider>
+ShardedAllocator<T, Mtx, COUNT, ALIGN, Layout, Provider>::ShardedAllocator(size_t count, bool cpu): count(count), cpu(cpu) {
+    if(this->count == 0) {
+        this->count = std::thread::hardware_concurrency();
+    }
+    if(this->count == 0) {
+        this->count = 1;
+    }
+
+    shards = std::make_unique<Shard[]>(this->count);
+}
+
+template<typename T, class Mtx, size_t COUNT, size_t ALIGN, class Layout, class Provider>
+template<typename U>
+U* ShardedAllocator<T, Mtx, COUNT, ALIGN, Layout, Provider>::Allocate() {
+    size_t         index = Index();
+    AllocatorType& shard = shards[index].allocator;
+
+    U* ptr = shard.template TryAllocate<U>();
+    if(ptr) {
+        return ptr;
+    }
+
+    // dry, segment of other shard is cheaper than a new one
+    // STEAL shards at most, start rotates so dry shards do not all hit the same one
+    size_t tries = count - 1 < STEAL ? count - 1 : STEAL;
+    size_t start = tries ? cursor.fetch_add(tries, std::memory_order_relaxed) : 0;
+    for(size_t i = 0; i < tries; ++i) {
+        size_t other = (index + 1 + (start + i) % (count - 1)) % count;
+        if(shard.Steal(shards[other].allocator)) {
+            break;
+        }
+    }
+    return shard.template Allocate<U>();
+}
+
+template<typename T, class Mtx, size_t COUNT, size_t ALIGN, class Layout, class Provider>
+template<typename U, typename... Args>
+U* ShardedAllocator<T, Mtx, COUNT, ALIGN, Layout, Provider>::Construct(Args&&... args) {
+    T* ptr = Allocate<T>();
+    if(ptr) new(ptr) T(std::forward<Args>(args)...);
+    return reinterpret_cast<U*>(ptr);
+}
+
+template<typename T, class Mtx, size_t COUNT, size_t ALIGN, class Layout, class Provider>
+template<typename U>
+void ShardedAllocator<T, Mtx, COUNT, ALIGN, Layout, Provider>::Deconstruct(U* ptr) {
+    if(ptr == nullptr) return;
+
+    reinterpret_cast<T*>(ptr)->~T();
+    Owner(ptr)->Deallocate(ptr);
+}
+
+template<typename T, class Mtx, size_t COUNT, size_t ALIGN, class Layout, class Provider>
+template<typename U>
+void ShardedAllocator<T, Mtx, COUNT, ALIGN, Layout, Provider>::Deallocate(U* ptr) {
+    if(ptr == nullptr) return;
+
+    // segment with a used chunk is never stolen, owner is stable
+    Owner(ptr)->Deallocate(ptr);
+}
+
+template<typename T, class Mtx, size_t COUNT, size_t ALIGN, class Layout, class Provider>
+size_t ShardedAllocator<T, Mtx, COUNT, ALIGN, Layout, Provider>::Expand(size_t count) {
+    return Local().Expand(count);
+}
+
+template<typename T, class Mtx, size_t COUNT, size_t ALIGN, class Layout, class Provider>
+size_t ShardedAllocator<T, Mtx, COUNT, ALIGN, Layout, Provider>::Reduce(size_t count) {
+    size_t reduced = 0;
+    for(size_t i = 0; i < this->count; ++i) {
+        reduced += shards[i].allocator.Reduce(count);
+    }
+    return reduced;
+}
+
+template<typename T, class Mtx, size_t COUNT, size_t ALIGN, class Layout, class Provider>
+size_t ShardedAllocator<T, Mtx, COUNT, ALIGN, Layout, Provider>::Trim(uint64_t now) {
+    size_t reduced = 0;
+    for(size_t i = 0; i < count; ++i) {
+        reduced += shards[i].allocator.Trim(now);
+    }
+    return reduced;
+}
+
+template<typename T, class Mtx, size_t COUNT, size_t ALIGN, class Layout, class Provider>
+void ShardedAllocator<T, Mtx, COUNT, ALIGN, Layout, Provider>::Retain(size_t blocks, size_t bytes) {
+    for(size_t i = 0; i < count; ++i) {
+        shards[i].allocator.Retain(blocks, bytes);
+    }
+}
+
+template<typename T, class Mtx, size_t COUNT, size_t ALIGN, class Layout, class Provider>
+void ShardedAllocator<T, Mtx, COUNT, ALIGN, Layout, Provider>::Decay(uint64_t ticks) {
+    for(size_t i = 0; i < count; ++i) {
+        shards[i].allocator.Decay(ticks);
+    }
+}
+
+template<typename T, class Mtx, size_t COUNT, size_t ALIGN, class Layout, class Provider>
+size_t ShardedAllocator<T, Mtx, COUNT, ALIGN, Layout, Provider>::Count() const {
+    return count;
+}
+
+template<typename T, class Mtx, size_t COUNT, size_t ALIGN, class Layout, class Provider>
+auto ShardedAllocator<T, Mtx, COUNT, ALIGN, Layout, Provider>::Local() -> AllocatorType& {
+    return shards[Index()].allocator;
+}
+
+template<typename T, class Mtx, size_t COUNT, size_t ALIGN, class Layout, class Provider>
+Memory::Usage ShardedAllocator<T, Mtx, COUNT, ALIGN, Layout, Provider>::Info() const {
+    Memory::Usage sum = { 0 };
+    for(size_t i = 0; i < count; ++i) {
+        sum += shards[i].allocator.INFO;
+    }
+    sum.chunk.footprint = shards[0].allocator.INFO.chunk.footprint;
+    return sum;
+}
+
+template<typename T, class Mtx, size_t COUNT, size_t ALIGN, class Layout, class Provider>
+size_t ShardedAllocator<T, Mtx, COUNT, ALIGN, Layout, Provider>::Index() const {
+    if(cpu) {
+#if defined(_WIN32)
+        return size_t(GetCurrentProcessorNumber()) % count;
+#elif defined(__linux__)
+        int id = sched_getcpu();
+        if(id >= 0) {
+            return size_t(id) % count;
+        }
+#endif
+    }
+
+    static thread_local size_t slot = sequence.fetch_add(1, std::memory_order_relaxed);
+    return slot % count;
+}
+
+template<typename T, class Mtx, size_t COUNT, size_t ALIGN, class Layout, class Provider>
+auto ShardedAllocator<T, Mtx, COUNT, ALIGN, Layout, Provider>::Owner(void* ptr) -> AllocatorType* {
+    return static_cast<AllocatorType*>(AllocatorType::Owner(ptr)->pool);
+}
+
+#endif
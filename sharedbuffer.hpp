@@ -0,0 +1,124 @@
+#ifndef LWE_UTILITIES_SHAREDBUFFER_HPP
+#define LWE_UTILITIES_SHAREDBUFFER_HPP
+
+#include <atomic>
+#include <cstring>
+#include <string>
+#include <string_view>
+
+#include "allocator.hpp"
+#include "config.h"
+#include "lock.hpp"
+
+template<size_t, class, size_t, size_t, class> class BufferChain;
+
+/*
+    reference counted buffer, copy on write
+    - the count lives in the pool chunk, in front of SIZE bytes
+    - copy: one count increment, no byte copied
+    - Slice(offset, length): view of the same chunk, one count increment
+    - read: Data(), operator[] const, View(), std::string of the view only
+    - write: Mutable(), operator[], Write(), a shared chunk is copied first (view bytes only)
+    - last handle returns the chunk to the pool
+
+    Buffer vs SharedBuffer
+    - Buffer owns SIZE bytes and copies them on copy
+    - SharedBuffer is a view [offset, offset + length) of a shared chunk
+
+    thread
+    - handles of one chunk may live on any thread, count is atomic
+    - a handle itself is not synchronized, same as std::shared_ptr
+
+    use
+
+    SharedPacket packet{ SharedPacket::Uninitialized() }; // no memset
+    size_t received = recv(socket, packet.Mutable(), packet.Size(), 0);
+    packet = packet.Slice(0, received);
+
+    for(Session& session : sessions) {
+        session.Send(packet); // N count increments, one chunk
+    }
+
+    SharedPacket body = packet.Slice(HEADER, received - HEADER);
+    body[0] = 1; // copied here when shared
+*/
+template<size_t SIZE = EConfig::BUFFER_SIZE_DEFAULT, class Mtx = SpinLock,
+    size_t POOL_CHUNK_COUNT = EConfig::MEMORY_ALLOCATE_DEFAULT,
+    size_t POOL_ALIGNMENT = EConfig::MEMORY_ALIGNMENT_DEFAULT,
+    class Provider = HeapProvider
+>
+class SharedBuffer {
+    template<size_t, class, size_t, size_t, class> friend class BufferChain; // grows views in place
+
+private:
+    struct Chunk {
+        std::atomic<size_t> ref;
+        uint8_t             data[SIZE];
+    };
+
+public:
+    using AllocatorType = Allocator<Chunk, Mtx, POOL_CHUNK_COUNT, POOL_ALIGNMENT, Linked, Provider>;
+
+public:
+    struct Uninitialized {}; // tag, chunk is not zeroed
+
+public:
+    static constexpr size_t Capacity(); // SIZE
+    static size_t           Reserve(size_t, bool touch = true); // pre-warm N chunks, see Allocator::Reserve
+
+public:
+    SharedBuffer(); // zeroed
+    explicit SharedBuffer(Uninitialized);
+    SharedBuffer(const SharedBuffer&);
+    SharedBuffer(SharedBuffer&&) noexcept;
+    SharedBuffer(std::string_view);
+
+public:
+    ~SharedBuffer();
+
+public:
+    SharedBuffer& operator=(const SharedBuffer&);
+    SharedBuffer& operator=(SharedBuffer&&) noexcept;
+
+public:
+    SharedBuffer Slice(size_t offset, size_t length = SIZE) const; // clamped to this view
+    size_t       Size() const;                                     // view length
+    size_t       References() const;                               // handles of the chunk, 0: empty
+    bool         Unique() const;
+
+public:
+    const uint8_t*   Data() const;
+    uint8_t*         Mutable();                                 // copy on write
+    size_t           Write(size_t offset, const void*, size_t); // copy on write, clamped
+    std::string_view View() const;
+
+public:
+    uint8_t  operator[](size_t) const;
+    uint8_t& operator[](size_t); // copy on write
+
+public:
+    operator std::string() const; // view bytes only
+
+private:
+    SharedBuffer(Chunk*, size_t offset, size_t length); // count taken
+
+private:
+    static Chunk* Acquire();      // count 1, not zeroed
+    static void   Drop(Chunk*);   // count - 1, release on 0
+
+private:
+    Chunk* chunk;
+    size_t offset;
+    size_t length;
+
+private:
+    static AllocatorType pool;
+};
+
+template<size_t SIZE, class Mtx, size_t COUNT, size_t ALIGN, class Provider>
+SharedBuffer<SIZE, Mtx, COUNT, ALIGN, Provider>::AllocatorType SharedBuffer<SIZE, Mtx, COUNT, ALIGN, Provider>::pool;
+
+using SharedPacket = SharedBuffer<EConfig::BUFFER_SIZE_DEFAULT>;
+
+#include "sharedbuffer.ipp"
+#endif
@@ -0,0 +1,186 @@
+#include "sharedbuffer.hpp"
+
+#ifdef LWE_UTILITIES_SHAREDBUFFER_HPP
+
+template<size_t SIZE, class Mtx, size_t COUNT, size_t ALIGN, class Provider>
+constexpr size_t SharedBuffer<SIZE, Mtx, COUNT, ALIGN, Provider>::Capacity() {
+    return SIZE;
+}
+
+template<size_t SIZE, class Mtx, size_t COUNT, size_t ALIGN, class Provider>
+size_t SharedBuffer<SIZE, Mtx, COUNT, ALIGN, Provider>::Reserve(size_t count, bool touch) {
+    return pool.Reserve(count, touch);
+}
+
+template<size_t SIZE, class Mtx, size_t COUNT, size_t ALIGN, class Provider>
+SharedBuffer<SIZE, Mtx, COUNT, ALIGN, Provider>::SharedBuffer(): SharedBuffer(Uninitialized()) {
+    if(chunk) ::memset(chunk->data, 0, SIZE);
+}
+
+template<size_t SIZE, class Mtx, size_t COUNT, size_t ALIGN, class Provider>
+SharedBuffer<SIZE, Mtx, COUNT, ALIGN, Provider>::SharedBuffer(Uninitialized): SharedBuffer(Acquire(), 0, SIZE) {}
+
+template<size_t SIZE, class Mtx, size_t COUNT, size_t ALIGN, class Provider>
+SharedBuffer<SIZE, Mtx, COUNT, ALIGN, Provider>::SharedBuffer(const SharedBuffer& ref): chunk(ref.chunk), offset(ref.offset), length(ref.length) {
+    if(chunk) chunk->ref.fetch_add(1, std::memory_order_relaxed);
+}
+
+template<size_t SIZE, class Mtx, size_t COUNT, size_t ALIGN, class Provider>
+SharedBuffer<SIZE, Mtx, COUNT, ALIGN, Provider>::SharedBuffer(SharedBuffer&& ref) noexcept: chunk(ref.chunk), offset(ref.offset), length(ref.length) {
+    ref.chunk  = nullptr;
+    ref.offset = 0;
+    ref.length = 0;
+}
+
+template<size_t SIZE, class Mtx, size_t COUNT, size_t ALIGN, class Provider>
+SharedBuffer<SIZE, Mtx, COUNT, ALIGN, Provider>::SharedBuffer(std::string_view str): SharedBuffer(Uninitialized()) {
+    length = SIZE < str.size() ? SIZE : str.size();
+    if(chunk) ::memcpy(chunk->data, str.data(), length);
+}
+
+template<size_t SIZE, class Mtx, size_t COUNT, size_t ALIGN, class Provider>
+SharedBuffer<SIZE, Mtx, COUNT, ALIGN, Provider>::SharedBuffer(Chunk* chunk, size_t offset, size_t length):
+    chunk(chunk), offset(offset), length(chunk ? length : 0) {}
+
+template<size_t SIZE, class Mtx, size_t COUNT, size_t ALIGN, class Provider>
+SharedBuffer<SIZE, Mtx, COUNT, ALIGN, Provider>::~SharedBuffer() {
+    Drop(chunk);
+}
+
+template<size_t SIZE, class Mtx, size_t COUNT, size_t ALIGN, class Provider>
+auto SharedBuffer<SIZE, Mtx, COUNT, ALIGN, Provider>::operator=(const SharedBuffer& ref) -> SharedBuffer& {
+    // increment first, ref may be a view of the same chunk
+    if(ref.chunk) ref.chunk->ref.fetch_add(1, std::memory_order_relaxed);
+    Drop(chunk);
+
+    chunk  = ref.chunk;
+    offset = ref.offset;
+    length = ref.length;
+    return *this;
+}
+
+template<size_t SIZE, class Mtx, size_t COUNT, size_t ALIGN, class Provider>
+auto SharedBuffer<SIZE, Mtx, COUNT, ALIGN, Provider>::operator=(SharedBuffer&& ref) noexcept -> SharedBuffer& {
+    if(this != &ref) {
+        Drop(chunk);
+
+        chunk      = ref.chunk;
+        offset     = ref.offset;
+        length     = ref.length;
+        ref.chunk  = nullptr;
+        ref.offset = 0;
+        ref.length = 0;
+    }
+    return *this;
+}
+
+template<size_t SIZE, class Mtx, size_t COUNT, size_t ALIGN, class Provider>
+auto SharedBuffer<SIZE, Mtx, COUNT, ALIGN, Provider>::Slice(size_t offset, size_t length) const -> SharedBuffer {
+    if(!chunk) {
+        return SharedBuffer(nullptr, 0, 0);
+    }
+
+    if(offset > this->length) offset = this->length;
+    if(length > this->length - offset) length = this->length - offset;
+
+    chunk->ref.fetch_add(1, std::memory_order_relaxed);
+    return SharedBuffer(chunk, this->offset + offset, length);
+}
+
+template<size_t SIZE, class Mtx, size_t COUNT, size_t ALIGN, class Provider>
+size_t SharedBuffer<SIZE, Mtx, COUNT, ALIGN, Provider>::Size() const {
+    return length;
+}
+
+template<size_t SIZE, class Mtx, size_t COUNT, size_t ALIGN, class Provider>
+size_t SharedBuffer<SIZE, Mtx, COUNT, ALIGN, Provider>::References() const {
+    return chunk ? chunk->ref.load(std::memory_order_relaxed) : 0;
+}
+
+template<size_t SIZE, class Mtx, size_t COUNT, size_t ALIGN, class Provider>
+bool SharedBuffer<SIZE, Mtx, COUNT, ALIGN, Provider>::Unique() const {
+    // acquire: writes of the handles dropped before are visible
+    return chunk && chunk->ref.load(std::memory_order_acquire) == 1;
+}
+
+template<size_t SIZE, class Mtx, size_t COUNT, size_t ALIGN, class Provider>
+const uint8_t* SharedBuffer<SIZE, Mtx, COUNT, ALIGN, Provider>::Data() const {
+    return chunk ? chunk->data + offset : nullptr;
+}
+
+template<size_t SIZE, class Mtx, size_t COUNT, size_t ALIGN, class Provider>
+uint8_t* SharedBuffer<SIZE, Mtx, COUNT, ALIGN, Provider>::Mutable() {
+    if(!chunk) {
+        return nullptr;
+    }
+
+    // only handle, no other one can appear without copying this one
+    if(Unique()) {
+        return chunk->data + offset;
+    }
+
+    Chunk* copy = Acquire();
+    if(!copy) {
+        return nullptr;
+    }
+    ::memcpy(copy->data, chunk->data + offset, length);
+
+    Drop(chunk);
+    chunk  = copy;
+    offset = 0;
+    return chunk->data;
+}
+
+template<size_t SIZE, class Mtx, size_t COUNT, size_t ALIGN, class Provider>
+size_t SharedBuffer<SIZE, Mtx, COUNT, ALIGN, Provider>::Write(size_t offset, const void* data, size_t size) {
+    if(offset >= length) {
+        return 0;
+    }
+    if(size > length - offset) size = length - offset;
+
+    uint8_t* target = Mutable();
+    if(!target) {
+        return 0;
+    }
+    ::memcpy(target + offset, data, size);
+    return size;
+}
+
+template<size_t SIZE, class Mtx, size_t COUNT, size_t ALIGN, class Provider>
+std::string_view SharedBuffer<SIZE, Mtx, COUNT, ALIGN, Provider>::View() const {
+    return std::string_view(reinterpret_cast<const char*>(Data()), length);
+}
+
+template<size_t SIZE, class Mtx, size_t COUNT, size_t ALIGN, class Provider>
+uint8_t SharedBuffer<SIZE, Mtx, COUNT, ALIGN, Provider>::operator[](size_t i) const {
+    return chunk->data[offset + i];
+}
+
+template<size_t SIZE, class Mtx, size_t COUNT, size_t ALIGN, class Provider>
+uint8_t& SharedBuffer<SIZE, Mtx, COUNT, ALIGN, Provider>::operator[](size_t i) {
+    return Mutable()[i];
+}
+
+template<size_t SIZE, class Mtx, size_t COUNT, size_t ALIGN, class Provider>
+SharedBuffer<SIZE, Mtx, COUNT, ALIGN, Provider>::operator std::string() const {
+    return std::string(View());
+}
+
+template<size_t SIZE, class Mtx, size_t COUNT, size_t ALIGN, class Provider>
+auto SharedBuffer<SIZE, Mtx, COUNT, ALIGN, Provider>::Acquire() -> Chunk* {
+    Chunk* chunk = pool.template Allocate<Chunk>();
+    if(chunk) {
+        new(&chunk->ref) std::atomic<size_t>(1);
+    }
+    return chunk;
+}
+
+template<size_t SIZE, class Mtx, size_t COUNT, size_t ALIGN, class Provider>
+void SharedBuffer<SIZE, Mtx, COUNT, ALIGN, Provider>::Drop(Chunk* chunk) {
+    // acq_rel: writes of every handle happen before the release
+    if(chunk && chunk->ref.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+        pool.Deallocate(chunk);
+    }
+}
+
+#endif
@@ -0,0 +1,87 @@
+#ifndef LWE_UTILITIES_SIMD_HPP
+#define LWE_UTILITIES_SIMD_HPP
+
+#include <bit>
+#include <cstdint>
+#include <cstring>
+
+#if defined(__x86_64__) || defined(_M_X64)
+#    define LWE_SIMD_X86
+#    include <immintrin.h>
+#    if defined(_MSC_VER) && !defined(__clang__)
+#        include <intrin.h>
+#        define LWE_SIMD_AVX2
+#    else
+#        define LWE_SIMD_AVX2 __attribute__((target("avx2")))
+#    endif
+#endif
+
+#include "macro.h"
+
+/*
+    byte kernels, dispatched once by cpu
+    - AVX2 (32 byte), SSE2 (16 byte, every x86-64), SCALAR (libc, other cpu)
+    - Copy / Fill      : no overlap, short tail by one overlapping vector
+    - Equal / Compare  : first mismatch by vector compare, memcmp sign
+    - Find(byte)       : first position of a byte, NOT_FOUND
+    - Find(pattern)    : Find(first byte) while candidates are rare, after SEARCH_MISS wrong ones
+                         first and last byte of pattern compared per vector, middle by memcmp
+    - Length           : strnlen, libc reads by aligned vectors and never crosses a page
+
+    Use(level): lower level for a bench or a test, before any other thread calls a kernel
+
+    use
+
+    size_t end = Simd::Find(data, size, "\r\n", 2);
+    if(end != Simd::NOT_FOUND) Parse(data, end);
+
+    Simd::Use(Simd::SSE2);
+*/
+class Simd {
+public:
+    NO_INSTANTIABLE(Simd);
+
+public:
+    enum Level {
+        SCALAR,
+        SSE2,
+        AVX2,
+    };
+
+    static constexpr size_t NOT_FOUND = SIZE_MAX;
+
+public:
+    static Level Detect(); // best of this cpu
+    static Level Current();
+    static void  Use(Level); // clamped to Detect()
+
+public:
+    static void   Copy(void*, const void*, size_t);
+    static void   Fill(void*, uint8_t, size_t);
+    static bool   Equal(const void*, const void*, size_t);
+    static int    Compare(const void*, const void*, size_t);
+    static size_t Find(const void*, size_t, uint8_t);
+    static size_t Find(const void*, size_t, const void* pattern, size_t length);
+    static size_t Length(const char*, size_t max);
+
+private:
+    struct Table {
+        Level  level;
+        void   (*copy)(uint8_t*, const uint8_t*, size_t);
+        void   (*fill)(uint8_t*, uint8_t, size_t);
+        size_t (*mismatch)(const uint8_t*, const uint8_t*, size_t); // size: equal
+        size_t (*find)(const uint8_t*, size_t, uint8_t);
+        size_t (*search)(const uint8_t*, size_t, const uint8_t*, size_t); // length >= 2
+    };
+
+    template<Level> struct Kernel;
+
+    static constexpr size_t SEARCH_MISS = 16;
+
+private:
+    static const Table*& Active();
+    static const Table&  Of(Level);
+};
+
+#include "simd.ipp"
+#endif
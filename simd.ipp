@@ -0,0 +1,486 @@
+#include "simd.hpp"
+
+#ifdef LWE_UTILITIES_SIMD_HPP
+
+template<> struct Simd::Kernel<Simd::SCALAR> {
+    // size 0 may come with a null pointer, libc does not take one
+    static void Copy(uint8_t* target, const uint8_t* source, size_t size) {
+        if(size) ::memcpy(target, source, size);
+    }
+
+    static void Fill(uint8_t* target, uint8_t value, size_t size) {
+        if(size) ::memset(target, value, size);
+    }
+
+    static size_t Mismatch(const uint8_t* a, const uint8_t* b, size_t size) {
+        if(size == 0 || ::memcmp(a, b, size) == 0) {
+            return size;
+        }
+
+        size_t i = 0;
+
+        // 8 byte words, first different byte by xor
+        for(; i + 8 <= size; i += 8) {
+            uint64_t x, y;
+            ::memcpy(&x, a + i, 8);
+            ::memcpy(&y, b + i, 8);
+            if(x != y) {
+                if constexpr(std::endian::native == std::endian::little) {
+                    return i + (std::countr_zero(x ^ y) >> 3);
+                }
+                else return i + (std::countl_zero(x ^ y) >> 3);
+            }
+        }
+
+        for(; i < size; ++i) {
+            if(a[i] != b[i]) return i;
+        }
+        return size;
+    }
+
+    static size_t Find(const uint8_t* data, size_t size, uint8_t value) {
+        const void* found = size ? ::memchr(data, value, size) : nullptr;
+        return found ? static_cast<const uint8_t*>(found) - data : NOT_FOUND;
+    }
+
+    static size_t Search(const uint8_t* data, size_t size, const uint8_t* pattern, size_t length) {
+        // candidates by the first byte
+        for(size_t i = 0; i + length <= size; ++i) {
+            size_t at = Find(data + i, size - length + 1 - i, pattern[0]);
+            if(at == NOT_FOUND) {
+                break;
+            }
+
+            i += at;
+            if(::memcmp(data + i + 1, pattern + 1, length - 1) == 0) {
+                return i;
+            }
+        }
+        return NOT_FOUND;
+    }
+};
+
+#ifdef LWE_SIMD_X86
+
+template<> struct Simd::Kernel<Simd::SSE2> {
+    static void Copy(uint8_t* target, const uint8_t* source, size_t size) {
+        if(size < 16) {
+            Kernel<SCALAR>::Copy(target, source, size);
+            return;
+        }
+
+        // head unaligned, then stores aligned to target
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(target), _mm_loadu_si128(reinterpret_cast<const __m128i*>(source)));
+        size_t i = 16 - (reinterpret_cast<uintptr_t>(target) & 15);
+        for(; i + 64 <= size; i += 64) {
+            __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(source + i));
+            __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(source + i + 16));
+            __m128i c = _mm_loadu_si128(reinterpret_cast<const __m128i*>(source + i + 32));
+            __m128i d = _mm_loadu_si128(reinterpret_cast<const __m128i*>(source + i + 48));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(target + i), a);
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(target + i + 16), b);
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(target + i + 32), c);
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(target + i + 48), d);
+        }
+        for(; i + 16 <= size; i += 16) {
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(target + i), _mm_loadu_si128(reinterpret_cast<const __m128i*>(source + i)));
+        }
+
+        // tail: last vector, overlaps bytes already copied
+        if(i < size) {
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(target + size - 16), _mm_loadu_si128(reinterpret_cast<const __m128i*>(source + size - 16)));
+        }
+    }
+
+    static void Fill(uint8_t* target, uint8_t value, size_t size) {
+        if(size < 16) {
+            Kernel<SCALAR>::Fill(target, value, size);
+            return;
+        }
+
+        __m128i v = _mm_set1_epi8(static_cast<char>(value));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(target), v);
+        size_t i = 16 - (reinterpret_cast<uintptr_t>(target) & 15);
+        for(; i + 64 <= size; i += 64) {
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(target + i), v);
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(target + i + 16), v);
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(target + i + 32), v);
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(target + i + 48), v);
+        }
+        for(; i + 16 <= size; i += 16) {
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(target + i), v);
+        }
+        if(i < size) {
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(target + size - 16), v);
+        }
+    }
+
+    static size_t Mismatch(const uint8_t* a, const uint8_t* b, size_t size) {
+        if(size < 16) {
+            return Kernel<SCALAR>::Mismatch(a, b, size);
+        }
+
+        // 64 byte per step, one test for all four vectors
+        size_t i = 0;
+        for(; i + 64 <= size; i += 64) {
+            __m128i x = _mm_cmpeq_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(a + i)), _mm_loadu_si128(reinterpret_cast<const __m128i*>(b + i)));
+            __m128i y = _mm_cmpeq_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(a + i + 16)), _mm_loadu_si128(reinterpret_cast<const __m128i*>(b + i + 16)));
+            __m128i z = _mm_cmpeq_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(a + i + 32)), _mm_loadu_si128(reinterpret_cast<const __m128i*>(b + i + 32)));
+            __m128i w = _mm_cmpeq_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(a + i + 48)), _mm_loadu_si128(reinterpret_cast<const __m128i*>(b + i + 48)));
+            if(static_cast<unsigned>(_mm_movemask_epi8(_mm_and_si128(_mm_and_si128(x, y), _mm_and_si128(z, w)))) != 0xFFFFu) {
+                break;
+            }
+        }
+
+        for(;; i += 16) {
+            // tail: last vector, bytes before i are equal
+            if(i + 16 > size) {
+                if(i == size) return size;
+                i = size - 16;
+            }
+
+            unsigned diff = ~static_cast<unsigned>(_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(a + i)), _mm_loadu_si128(reinterpret_cast<const __m128i*>(b + i))))) & 0xFFFFu;
+            if(diff) {
+                return i + std::countr_zero(diff);
+            }
+            if(i + 16 == size) {
+                return size;
+            }
+        }
+    }
+
+    static size_t Find(const uint8_t* data, size_t size, uint8_t value) {
+        if(size < 16) {
+            return Kernel<SCALAR>::Find(data, size, value);
+        }
+
+        __m128i v = _mm_set1_epi8(static_cast<char>(value));
+        size_t  i = 0;
+        for(; i + 64 <= size; i += 64) {
+            __m128i x = _mm_cmpeq_epi8(v, _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i)));
+            __m128i y = _mm_cmpeq_epi8(v, _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i + 16)));
+            __m128i z = _mm_cmpeq_epi8(v, _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i + 32)));
+            __m128i w = _mm_cmpeq_epi8(v, _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i + 48)));
+            if(_mm_movemask_epi8(_mm_or_si128(_mm_or_si128(x, y), _mm_or_si128(z, w)))) {
+                break;
+            }
+        }
+
+        for(;; i += 16) {
+            // tail: last vector, bytes before i did not match
+            if(i + 16 > size) {
+                if(i == size) return NOT_FOUND;
+                i = size - 16;
+            }
+
+            unsigned hit = static_cast<unsigned>(_mm_movemask_epi8(_mm_cmpeq_epi8(v, _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i)))));
+            if(hit) {
+                return i + std::countr_zero(hit);
+            }
+            if(i + 16 == size) {
+                return NOT_FOUND;
+            }
+        }
+    }
+
+    static size_t Search(const uint8_t* data, size_t size, const uint8_t* pattern, size_t length) {
+        __m128i first = _mm_set1_epi8(static_cast<char>(pattern[0]));
+        __m128i last  = _mm_set1_epi8(static_cast<char>(pattern[length - 1]));
+        size_t  i     = 0;
+
+        // 64 candidates per step, first and last byte both match, one test for all four vectors
+        for(; i + length - 1 + 64 <= size; i += 64) {
+            __m128i match[4] = { _mm_and_si128(_mm_cmpeq_epi8(first, _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i))), _mm_cmpeq_epi8(last, _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i + length - 1)))),
+                _mm_and_si128(_mm_cmpeq_epi8(first, _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i + 16))), _mm_cmpeq_epi8(last, _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i + length - 1 + 16)))),
+                _mm_and_si128(_mm_cmpeq_epi8(first, _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i + 32))), _mm_cmpeq_epi8(last, _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i + length - 1 + 32)))),
+                _mm_and_si128(_mm_cmpeq_epi8(first, _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i + 48))), _mm_cmpeq_epi8(last, _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i + length - 1 + 48)))) };
+            if(!_mm_movemask_epi8(_mm_or_si128(_mm_or_si128(match[0], match[1]), _mm_or_si128(match[2], match[3])))) {
+                continue;
+            }
+
+            for(size_t k = 0; k < 4; ++k) {
+                for(uint32_t hit = static_cast<uint32_t>(_mm_movemask_epi8(match[k])); hit; hit &= hit - 1) {
+                    size_t at = i + k * 16 + std::countr_zero(hit);
+                    if(::memcmp(data + at + 1, pattern + 1, length - 2) == 0) {
+                        return at;
+                    }
+                }
+            }
+        }
+
+        size_t at = Kernel<SCALAR>::Search(data + i, size - i, pattern, length);
+        return at == NOT_FOUND ? NOT_FOUND : i + at;
+    }
+};
+
+template<> struct Simd::Kernel<Simd::AVX2> {
+    LWE_SIMD_AVX2 static void Copy(uint8_t* target, const uint8_t* source, size_t size) {
+        if(size < 32) {
+            Kernel<SSE2>::Copy(target, source, size);
+            return;
+        }
+
+        // head unaligned, then stores aligned to target
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(target), _mm256_loadu_si256(reinterpret_cast<const __m256i*>(source)));
+        size_t i = 32 - (reinterpret_cast<uintptr_t>(target) & 31);
+        for(; i + 128 <= size; i += 128) {
+            __m256i a = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(source + i));
+            __m256i b = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(source + i + 32));
+            __m256i c = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(source + i + 64));
+            __m256i d = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(source + i + 96));
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(target + i), a);
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(target + i + 32), b);
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(target + i + 64), c);
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(target + i + 96), d);
+        }
+        for(; i + 32 <= size; i += 32) {
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(target + i), _mm256_loadu_si256(reinterpret_cast<const __m256i*>(source + i)));
+        }
+
+        // tail: last vector, overlaps bytes already copied
+        if(i < size) {
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(target + size - 32), _mm256_loadu_si256(reinterpret_cast<const __m256i*>(source + size - 32)));
+        }
+    }
+
+    LWE_SIMD_AVX2 static void Fill(uint8_t* target, uint8_t value, size_t size) {
+        if(size < 32) {
+            Kernel<SSE2>::Fill(target, value, size);
+            return;
+        }
+
+        __m256i v = _mm256_set1_epi8(static_cast<char>(value));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(target), v);
+        size_t i = 32 - (reinterpret_cast<uintptr_t>(target) & 31);
+        for(; i + 128 <= size; i += 128) {
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(target + i), v);
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(target + i + 32), v);
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(target + i + 64), v);
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(target + i + 96), v);
+        }
+        for(; i + 32 <= size; i += 32) {
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(target + i), v);
+        }
+        if(i < size) {
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(target + size - 32), v);
+        }
+    }
+
+    LWE_SIMD_AVX2 static size_t Mismatch(const uint8_t* a, const uint8_t* b, size_t size) {
+        if(size < 32) {
+            return Kernel<SSE2>::Mismatch(a, b, size);
+        }
+
+        // 128 byte per step, one test for all four vectors
+        size_t i = 0;
+        for(; i + 128 <= size; i += 128) {
+            __m256i x = _mm256_cmpeq_epi8(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(a + i)), _mm256_loadu_si256(reinterpret_cast<const __m256i*>(b + i)));
+            __m256i y = _mm256_cmpeq_epi8(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(a + i + 32)), _mm256_loadu_si256(reinterpret_cast<const __m256i*>(b + i + 32)));
+            __m256i z = _mm256_cmpeq_epi8(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(a + i + 64)), _mm256_loadu_si256(reinterpret_cast<const __m256i*>(b + i + 64)));
+            __m256i w = _mm256_cmpeq_epi8(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(a + i + 96)), _mm256_loadu_si256(reinterpret_cast<const __m256i*>(b + i + 96)));
+            if(static_cast<unsigned>(_mm256_movemask_epi8(_mm256_and_si256(_mm256_and_si256(x, y), _mm256_and_si256(z, w)))) != 0xFFFFFFFFu) {
+                break;
+            }
+        }
+
+        for(;; i += 32) {
+            // tail: last vector, bytes before i are equal
+            if(i + 32 > size) {
+                if(i == size) return size;
+                i = size - 32;
+            }
+
+            unsigned diff = ~static_cast<unsigned>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(a + i)), _mm256_loadu_si256(reinterpret_cast<const __m256i*>(b + i)))));
+            if(diff) {
+                return i + std::countr_zero(diff);
+            }
+            if(i + 32 == size) {
+                return size;
+            }
+        }
+    }
+
+    LWE_SIMD_AVX2 static size_t Find(const uint8_t* data, size_t size, uint8_t value) {
+        if(size < 32) {
+            return Kernel<SSE2>::Find(data, size, value);
+        }
+
+        __m256i v = _mm256_set1_epi8(static_cast<char>(value));
+        size_t  i = 0;
+        for(; i + 128 <= size; i += 128) {
+            __m256i x = _mm256_cmpeq_epi8(v, _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i)));
+            __m256i y = _mm256_cmpeq_epi8(v, _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i + 32)));
+            __m256i z = _mm256_cmpeq_epi8(v, _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i + 64)));
+            __m256i w = _mm256_cmpeq_epi8(v, _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i + 96)));
+            if(_mm256_movemask_epi8(_mm256_or_si256(_mm256_or_si256(x, y), _mm256_or_si256(z, w)))) {
+                break;
+            }
+        }
+
+        for(;; i += 32) {
+            // tail: last vector, bytes before i did not match
+            if(i + 32 > size) {
+                if(i == size) return NOT_FOUND;
+                i = size - 32;
+            }
+
+            unsigned hit = static_cast<unsigned>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(v, _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i)))));
+            if(hit) {
+                return i + std::countr_zero(hit);
+            }
+            if(i + 32 == size) {
+                return NOT_FOUND;
+            }
+        }
+    }
+
+    LWE_SIMD_AVX2 static size_t Search(const uint8_t* data, size_t size, const uint8_t* pattern, size_t length) {
+        __m256i first = _mm256_set1_epi8(static_cast<char>(pattern[0]));
+        __m256i last  = _mm256_set1_epi8(static_cast<char>(pattern[length - 1]));
+        size_t  i     = 0;
+
+        // 128 candidates per step, first and last byte both match, one test for all four vectors
+        for(; i + length - 1 + 128 <= size; i += 128) {
+            __m256i match[4] = { _mm256_and_si256(_mm256_cmpeq_epi8(first, _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i))), _mm256_cmpeq_epi8(last, _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i + length - 1)))),
+                _mm256_and_si256(_mm256_cmpeq_epi8(first, _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i + 32))), _mm256_cmpeq_epi8(last, _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i + length - 1 + 32)))),
+                _mm256_and_si256(_mm256_cmpeq_epi8(first, _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i + 64))), _mm256_cmpeq_epi8(last, _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i + length - 1 + 64)))),
+                _mm256_and_si256(_mm256_cmpeq_epi8(first, _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i + 96))), _mm256_cmpeq_epi8(last, _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i + length - 1 + 96)))) };
+            if(!_mm256_movemask_epi8(_mm256_or_si256(_mm256_or_si256(match[0], match[1]), _mm256_or_si256(match[2], match[3])))) {
+                continue;
+            }
+
+            for(size_t k = 0; k < 4; ++k) {
+                for(uint32_t hit = static_cast<uint32_t>(_mm256_movemask_epi8(match[k])); hit; hit &= hit - 1) {
+                    size_t at = i + k * 32 + std::countr_zero(hit);
+                    if(::memcmp(data + at + 1, pattern + 1, length - 2) == 0) {
+                        return at;
+                    }
+                }
+            }
+        }
+
+        size_t at = Kernel<SSE2>::Search(data + i, size - i, pattern, length);
+        return at == NOT_FOUND ? NOT_FOUND : i + at;
+    }
+};
+
+#endif
+
+inline Simd::Level Simd::Detect() {
+#if defined(LWE_SIMD_X86) && defined(_MSC_VER) && !defined(__clang__)
+    // avx2 by cpu, ymm state saved by os
+    int info[4];
+    __cpuid(info, 1);
+    if(!(info[2] & (1 << 27)) || (_xgetbv(0) & 6) != 6) {
+        return SSE2;
+    }
+    __cpuidex(info, 7, 0);
+    return (info[1] & (1 << 5)) ? AVX2 : SSE2;
+#elif defined(LWE_SIMD_X86)
+    return __builtin_cpu_supports("avx2") ? AVX2 : SSE2;
+#else
+    return SCALAR;
+#endif
+}
+
+inline Simd::Level Simd::Current() {
+    return Active()->level;
+}
+
+inline void Simd::Use(Level level) {
+    Level best = Detect();
+    Active()   = &Of(level < best ? level : best);
+}
+
+inline void Simd::Copy(void* target, const void* source, size_t size) {
+    Active()->copy(static_cast<uint8_t*>(target), static_cast<const uint8_t*>(source), size);
+}
+
+inline void Simd::Fill(void* target, uint8_t value, size_t size) {
+    Active()->fill(static_cast<uint8_t*>(target), value, size);
+}
+
+inline bool Simd::Equal(const void* a, const void* b, size_t size) {
+    return Active()->mismatch(static_cast<const uint8_t*>(a), static_cast<const uint8_t*>(b), size) == size;
+}
+
+inline int Simd::Compare(const void* a, const void* b, size_t size) {
+    const uint8_t* x  = static_cast<const uint8_t*>(a);
+    const uint8_t* y  = static_cast<const uint8_t*>(b);
+    size_t         at = Active()->mismatch(x, y, size);
+    return at == size ? 0 : int(x[at]) - int(y[at]);
+}
+
+inline size_t Simd::Find(const void* data, size_t size, uint8_t value) {
+    return Active()->find(static_cast<const uint8_t*>(data), size, value);
+}
+
+inline size_t Simd::Find(const void* data, size_t size, const void* pattern, size_t length) {
+    if(length == 0) {
+        return 0;
+    }
+    if(length > size) {
+        return NOT_FOUND;
+    }
+    if(length == 1) {
+        return Find(data, size, *static_cast<const uint8_t*>(pattern));
+    }
+
+    const Table&   table  = *Active();
+    const uint8_t* source = static_cast<const uint8_t*>(data);
+    const uint8_t* target = static_cast<const uint8_t*>(pattern);
+
+    // rare first byte: Find skips the data, dense one: first and last byte filter from there
+    for(size_t i = 0, miss = 0; i + length <= size; ++i) {
+        if(miss == SEARCH_MISS) {
+            size_t at = table.search(source + i, size - i, target, length);
+            return at == NOT_FOUND ? NOT_FOUND : i + at;
+        }
+
+        size_t at = table.find(source + i, size - length + 1 - i, target[0]);
+        if(at == NOT_FOUND) {
+            break;
+        }
+
+        i += at;
+        if(::memcmp(source + i + 1, target + 1, length - 1) == 0) {
+            return i;
+        }
+        ++miss;
+    }
+    return NOT_FOUND;
+}
+
+inline size_t Simd::Length(const char* str, size_t max) {
+    // not a kernel: reading past the terminator is only safe inside one page, libc handles it
+    return ::strnlen(str, max);
+}
+
+inline auto Simd::Active() -> const Table*& {
+    static const Table* active = &Of(Detect());
+    return active;
+}
+
+inline auto Simd::Of(Level level) -> const Table& {
+    static const Table scalar = {
+        SCALAR, &Kernel<SCALAR>::Copy, &Kernel<SCALAR>::Fill, &Kernel<SCALAR>::Mismatch, &Kernel<SCALAR>::Find, &Kernel<SCALAR>::Search
+    };
+
+#ifdef LWE_SIMD_X86
+    static const Table sse2 = {
+        SSE2, &Kernel<SSE2>::Copy, &Kernel<SSE2>::Fill, &Kernel<SSE2>::Mismatch, &Kernel<SSE2>::Find, &Kernel<SSE2>::Search
+    };
+    static const Table avx2 = {
+        AVX2, &Kernel<AVX2>::Copy, &Kernel<AVX2>::Fill, &Kernel<AVX2>::Mismatch, &Kernel<AVX2>::Find, &Kernel<AVX2>::Search
+    };
+
+    switch(level) {
+        case AVX2: return avx2;
+        case SSE2: return sse2;
+        default: break;
+    }
+#endif
+    return scalar;
+}
+
+#endif
@@ -0,0 +1,100 @@
+#ifndef LWE_UTILITIES_SIZECLASS_HPP
+#define LWE_UTILITIES_SIZECLASS_HPP
+
+#include <stdexcept>
+#include <tuple>
+#include <utility>
+
+#include "allocator.hpp"
+
+/*
+    variable size allocator
+    - one Allocator<Block<N>, Mtx, ..., Masked> per size class
+    - every class segment is SPAN byte and SPAN aligned
+    - Deallocate(ptr) finds its segment by address mask, size is not needed
+    - class index is the segment tag, checked against the segment pool
+    - larger than MAX_SIZE: direct Provider allocation with the same header
+
+    class table, 16 byte aligned
+    16 ~ 128       : step 16
+    128 ~ MAX_SIZE : 4 classes per power of two
+
+    use
+
+    SizeClassAllocator<> heap;
+
+    void* msg = heap.Allocate(200); // 224 byte class
+    heap.Capacity(msg);             // 224
+    heap.Deallocate(msg);
+*/
+template<class Mtx = SpinLock, size_t SPAN = EConfig::MEMORY_SIZE_CLASS_SPAN_DEFAULT, class Provider = HeapProvider>
+class SizeClassAllocator {
+    static_assert((SPAN & (SPAN - 1)) == 0, "SPAN must be power of two.");
+
+public:
+    NO_COPYABLE(SizeClassAllocator);
+    NO_MOVABLE(SizeClassAllocator);
+
+public:
+    static constexpr size_t ALIGNMENT = 16;
+    static constexpr size_t MAX_SIZE  = SPAN / 8;
+
+private:
+    static constexpr size_t HEADER = sizeof(Aligner<ALIGNMENT, Memory::Segment>::Type);
+
+    static constexpr size_t ClassCount();
+    static constexpr size_t ClassSize(size_t);
+
+public:
+    static constexpr size_t CLASS_COUNT = ClassCount();
+
+private:
+    template<size_t I> using Class =
+        Allocator<Block<ClassSize(I)>, Mtx, (SPAN - HEADER) / ClassSize(I), ALIGNMENT, Masked, Provider>;
+
+    template<typename> struct Family;
+    template<size_t... I> struct Family<std::index_sequence<I...>> {
+        using Type = std::tuple<Class<I>...>;
+    };
+
+    using Allocators = Family<std::make_index_sequence<CLASS_COUNT>>::Type;
+
+public:
+    SizeClassAllocator();
+
+public:
+    void*         Allocate(size_t);
+    void          Deallocate(void*);
+    size_t        Capacity(void*) const; // usable byte of allocated pointer
+    static size_t Index(size_t);         // class of size, CLASS_COUNT: large
+
+public:
+    Memory::Usage Info() const; // sum of classes
+
+private:
+    template<size_t I> static void* AllocateClass(SizeClassAllocator*);
+    template<size_t I> static void  DeallocateClass(SizeClassAllocator*, void*);
+    template<size_t... I> void      Bind(std::index_sequence<I...>);
+
+private:
+    void*       AllocateLarge(size_t);
+    void        DeallocateLarge(Memory::Segment*);
+    static void*            Large(); // pool of large segment
+
+private:
+    static Memory::Segment* Owner(void*);
+    size_t                  Find(Memory::Segment*) const; // class of segment
+
+private:
+    static inline char large = 0; // address marks large segment, no allocator has it
+
+private:
+    Allocators           family;
+    void*                pools[CLASS_COUNT];
+    const Memory::Usage* usages[CLASS_COUNT];
+    void* (*allocate[CLASS_COUNT])(SizeClassAllocator*);
+    void (*deallocate[CLASS_COUNT])(SizeClassAllocator*, void*);
+};
+
+#include "sizeclass.ipp"
+#endif
@@ -0,0 +1,156 @@
+#include "sizeclass.hpp"
+
+#ifdef LWE_UTILITIES_SIZECLASS_HPP
+
+#include <bit>
+
+template<class Mtx, size_t SPAN, class Provider>
+constexpr size_t SizeClassAllocator<Mtx, SPAN, Provider>::ClassSize(size_t index) {
+    if(index < 8) {
+        return ALIGNMENT * (index + 1);
+    }
+
+    size_t step  = index - 8;
+    size_t power = size_t(128) << (step / 4);
+    return power + (power / 4) * (step % 4 + 1);
+}
+
+template<class Mtx, size_t SPAN, class Provider>
+constexpr size_t SizeClassAllocator<Mtx, SPAN, Provider>::ClassCount() {
+    size_t count = 0;
+    while(ClassSize(count) <= MAX_SIZE) {
+        ++count;
+    }
+    return count;
+}
+
+template<class Mtx, size_t SPAN, class Provider>
+size_t SizeClassAllocator<Mtx, SPAN, Provider>::Index(size_t size) {
+    if(size > MAX_SIZE) {
+        return CLASS_COUNT;
+    }
+
+    if(size <= 128) {
+        return size ? (size + ALIGNMENT - 1) / ALIGNMENT - 1 : 0;
+    }
+
+    size_t bit   = std::bit_width(size - 1) - 1; // power < size <= power * 2
+    size_t power = size_t(1) << bit;
+    size_t step  = power / 4;
+    return 8 + (bit - 7) * 4 + (size - power + step - 1) / step - 1;
+}
+
+template<class Mtx, size_t SPAN, class Provider> SizeClassAllocator<Mtx, SPAN, Provider>::SizeClassAllocator() {
+    Bind(std::make_index_sequence<CLASS_COUNT>());
+}
+
+template<class Mtx, size_t SPAN, class Provider>
+template<size_t... I>
+void SizeClassAllocator<Mtx, SPAN, Provider>::Bind(std::index_sequence<I...>) {
+    static_assert(((Class<I>::BLOCK_TOTAL_SIZE == SPAN) && ...), "Segment of every class must be SPAN.");
+
+    ((pools[I] = static_cast<void*>(&std::get<I>(family))), ...);
+    (std::get<I>(family).Tag(I), ...);
+    ((usages[I] = &std::get<I>(family).INFO), ...);
+    ((allocate[I] = &AllocateClass<I>), ...);
+    ((deallocate[I] = &DeallocateClass<I>), ...);
+}
+
+template<class Mtx, size_t SPAN, class Provider>
+template<size_t I>
+void* SizeClassAllocator<Mtx, SPAN, Provider>::AllocateClass(SizeClassAllocator* self) {
+    return std::get<I>(self->family).template Allocate<void>();
+}
+
+template<class Mtx, size_t SPAN, class Provider>
+template<size_t I>
+void SizeClassAllocator<Mtx, SPAN, Provider>::DeallocateClass(SizeClassAllocator* self, void* ptr) {
+    std::get<I>(self->family).Deallocate(ptr);
+}
+
+template<class Mtx, size_t SPAN, class Provider> void* SizeClassAllocator<Mtx, SPAN, Provider>::Allocate(size_t size) {
+    size_t index = Index(size);
+    if(index == CLASS_COUNT) {
+        return AllocateLarge(size);
+    }
+    return allocate[index](this);
+}
+
+template<class Mtx, size_t SPAN, class Provider> void SizeClassAllocator<Mtx, SPAN, Provider>::Deallocate(void* ptr) {
+    if(ptr == nullptr) return;
+
+    Memory::Segment* block = Owner(ptr);
+    if(block->pool == Large()) {
+        DeallocateLarge(block);
+        return;
+    }
+
+    size_t index = Find(block);
+    if(index == CLASS_COUNT) {
+        throw std::runtime_error("Not part of this.");
+    }
+    deallocate[index](this, ptr);
+}
+
+template<class Mtx, size_t SPAN, class Provider> size_t SizeClassAllocator<Mtx, SPAN, Provider>::Capacity(void* ptr) const {
+    Memory::Segment* block = Owner(ptr);
+    if(block->pool == Large()) {
+        return block->used - HEADER;
+    }
+
+    size_t index = Find(block);
+    return index == CLASS_COUNT ? 0 : ClassSize(index);
+}
+
+template<class Mtx, size_t SPAN, class Provider> Memory::Usage SizeClassAllocator<Mtx, SPAN, Provider>::Info() const {
+    Memory::Usage sum = { 0 };
+    for(size_t i = 0; i < CLASS_COUNT; ++i) {
+        sum += *usages[i];
+    }
+    return sum;
+}
+
+template<class Mtx, size_t SPAN, class Provider> void* SizeClassAllocator<Mtx, SPAN, Provider>::AllocateLarge(size_t size) {
+    size_t total = HEADER + size;
+
+    // header at SPAN aligned address, same as class segment
+    Memory::Segment* block = static_cast<Memory::Segment*>(Provider::Allocate(total, SPAN));
+    if(!block) {
+        return nullptr;
+    }
+
+    block->pool   = Large();
+    block->head   = nullptr;
+    block->stamp  = 0;
+    block->used   = total;
+    block->carved = 0;
+    block->next   = nullptr;
+    block->prev   = nullptr;
+    block->tag    = CLASS_COUNT;
+
+    return reinterpret_cast<uint8_t*>(block) + HEADER;
+}
+
+template<class Mtx, size_t SPAN, class Provider> void SizeClassAllocator<Mtx, SPAN, Provider>::DeallocateLarge(Memory::Segment* block) {
+    Provider::Free(block, block->used, SPAN);
+}
+
+template<class Mtx, size_t SPAN, class Provider> void* SizeClassAllocator<Mtx, SPAN, Provider>::Large() {
+    return &large;
+}
+
+template<class Mtx, size_t SPAN, class Provider> Memory::Segment* SizeClassAllocator<Mtx, SPAN, Provider>::Owner(void* ptr) {
+    return reinterpret_cast<Memory::Segment*>(reinterpret_cast<uintptr_t>(ptr) & ~(SPAN - 1));
+}
+
+template<class Mtx, size_t SPAN, class Provider> size_t SizeClassAllocator<Mtx, SPAN, Provider>::Find(Memory::Segment* block) const {
+    size_t index = block->tag;
+
+    // other allocator or stray pointer
+    if(index >= CLASS_COUNT || pools[index] != block->pool) {
+        return CLASS_COUNT;
+    }
+    return index;
+}
+
+#endif
@@ -0,0 +1,41 @@
+#ifndef LWE_UTILITIES_SPARSESET_HPP
+#define LWE_UTILITIES_SPARSESET_HPP
+
+#include <vector>
+
+#include "config.h"
+#include "id.hpp"
+
+/*
+    paged sparse set of IDs, shared by Pool and DensePool
+    - table : dense index to ID, contiguous
+    - sparse: ID index to dense index, read directly by ID, pages of POOL_SPARSE_PAGE_DEFAULT
+    - Find: O(1), stale generation rejected by the ID kept in table
+    - Remove: swap remove, the last ID takes the hole
+
+    use
+
+    SparseSet set;
+    set.Slot(id) = set.table.size();
+    set.table.push_back(id);
+
+    size_t index = set.Find(id); // INVALID_INDEX: not found
+    set.Remove(index);
+*/
+struct SparseSet {
+    using Table  = std::vector<ID>;
+    using Sparse = std::vector<std::vector<size_t>>; // paged, empty page: not allocated
+
+    static constexpr size_t PAGE = EConfig::POOL_SPARSE_PAGE_DEFAULT;
+
+    size_t  Find(ID) const;  // dense index, INVALID_INDEX: not found
+    ID      Remove(size_t);  // swap remove, ID of index
+    size_t& Slot(ID);        // page on demand
+    void    Reserve(size_t); // table for N, pages up to ID index N
+
+    Table  table;
+    Sparse sparse;
+};
+
+#include "sparseset.ipp"
+#endif
@@ -0,0 +1,55 @@
+#include "sparseset.hpp"
+
+#ifdef LWE_UTILITIES_SPARSESET_HPP
+
+inline size_t SparseSet::Find(ID id) const {
+    size_t page = id.Index() / PAGE;
+    if(page >= sparse.size() || sparse[page].empty()) {
+        return ECode::INVALID_INDEX;
+    }
+
+    // stale generation
+    size_t index = sparse[page][id.Index() % PAGE];
+    if(index == size_t(ECode::INVALID_INDEX) || table[index] != id) {
+        return ECode::INVALID_INDEX;
+    }
+    return index;
+}
+
+inline ID SparseSet::Remove(size_t index) {
+    size_t last = table.size() - 1;
+    ID     id   = table[index];
+
+    Slot(table[last]) = index;
+    Slot(id)          = ECode::INVALID_INDEX;
+    table[index]      = table[last];
+    table.pop_back();
+    return id;
+}
+
+inline size_t& SparseSet::Slot(ID id) {
+    size_t page = id.Index() / PAGE;
+    if(page >= sparse.size()) {
+        sparse.resize(page + 1);
+    }
+    if(sparse[page].empty()) {
+        sparse[page].assign(PAGE, ECode::INVALID_INDEX);
+    }
+    return sparse[page][id.Index() % PAGE];
+}
+
+inline void SparseSet::Reserve(size_t count) {
+    table.reserve(count);
+
+    size_t pages = (count + PAGE - 1) / PAGE;
+    if(sparse.size() < pages) {
+        sparse.resize(pages);
+    }
+    for(size_t page = 0; page < pages; ++page) {
+        if(sparse[page].empty()) {
+            sparse[page].assign(PAGE, ECode::INVALID_INDEX);
+        }
+    }
+}
+
+#endif
@@ -0,0 +1,141 @@
+#ifndef LWE_UTILITIES_TELEMETRY_HPP
+#define LWE_UTILITIES_TELEMETRY_HPP
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <typeinfo>
+#include <vector>
+
+#if defined(__GNUG__)
+#    include <cxxabi.h>
+#endif
+
+#include "lock.hpp"
+#include "macro.h"
+
+/*
+    process wide registry of allocators
+    - every Allocator registers itself on construction, leaves on destruction
+    - Buffer<...>::pool, Pool<...>::allocator, size classes and shards are listed too
+    - counters are atomic, safe to read from a monitoring thread
+
+    entry
+    - name, CHUNK_SIZE, CHUNK_COUNT, ALIGNMENT, BLOCK_TOTAL_SIZE
+    - allocate / deallocate: chunks handed out / returned (ThreadCache: per refill / flush)
+    - fail: allocation failed on expand
+    - expand / reduce: segments created / released or decommitted
+    - used, total, committed: current chunks, chunks, byte
+    - peak.used, peak.committed: high-water marks
+
+    use
+
+    for(const Telemetry::Record& record : Telemetry::Snapshot()) {
+        // record.peak.used / record.chunkCount: segments needed at peak
+    }
+*/
+class Telemetry {
+public:
+    NO_INSTANTIABLE(Telemetry);
+
+public:
+    struct Geometry {
+        const char* name; // typeid name
+        size_t      chunkSize;
+        size_t      chunkCount;
+        size_t      alignment;
+        size_t      blockSize;
+    };
+
+    struct Record {
+        std::string name; // demangled
+        size_t      chunkSize;
+        size_t      chunkCount;
+        size_t      alignment;
+        size_t      blockSize;
+
+        uint64_t allocate;
+        uint64_t deallocate;
+        uint64_t fail;
+        uint64_t expand;
+        uint64_t reduce;
+
+        uint64_t used;
+        uint64_t total;
+        uint64_t committed;
+
+        struct {
+            uint64_t used;
+            uint64_t committed;
+        } peak;
+    };
+
+public:
+    /*
+        one allocator
+        shared: false when every update is under the allocator lock
+    */
+    class Entry {
+    public:
+        NO_COPYABLE(Entry);
+        NO_MOVABLE(Entry);
+
+    public:
+        Entry(const Geometry&, bool shared);
+        ~Entry();
+
+    public:
+        void Allocate(size_t count, size_t used);
+        void Deallocate(size_t count, size_t used);
+        void Fail();
+        void Expand(size_t total, size_t committed);
+        void Reduce(size_t total, size_t committed);
+        void Resize(size_t total, size_t committed); // moved, no expand / reduce
+
+    public:
+        Record Read() const;
+
+    private:
+        void Add(std::atomic<uint64_t>&, uint64_t);
+        void Max(std::atomic<uint64_t>&, uint64_t);
+
+    private:
+        Geometry geometry;
+        bool     shared;
+
+    private:
+        std::atomic<uint64_t> allocate   = 0;
+        std::atomic<uint64_t> deallocate = 0;
+        std::atomic<uint64_t> fail       = 0;
+        std::atomic<uint64_t> expand     = 0;
+        std::atomic<uint64_t> reduce     = 0;
+        std::atomic<uint64_t> used       = 0;
+        std::atomic<uint64_t> total      = 0;
+        std::atomic<uint64_t> committed  = 0;
+        std::atomic<uint64_t> peakUsed   = 0;
+        std::atomic<uint64_t> peakByte   = 0;
+
+    private:
+        Entry* next = nullptr;
+        Entry* prev = nullptr;
+
+        friend class Telemetry;
+    };
+
+public:
+    static std::vector<Record> Snapshot();
+    static std::string         Demangle(const char*);
+
+private:
+    struct Registry {
+        TTASLock mtx;
+        Entry*   head = nullptr;
+    };
+
+    static Registry& Instance(); // constructed on first use, outlives static allocators
+    static void      Register(Entry*);
+    static void      Unregister(Entry*);
+};
+
+#include "telemetry.ipp"
+#endif
@@ -0,0 +1,138 @@
+#include "telemetry.hpp"
+
+#ifdef LWE_UTILITIES_TELEMETRY_HPP
+
+#include <cstdlib>
+
+inline Telemetry::Entry::Entry(const Geometry& geometry, bool shared): geometry(geometry), shared(shared) {
+    Telemetry::Register(this);
+}
+
+inline Telemetry::Entry::~Entry() {
+    Telemetry::Unregister(this);
+}
+
+inline void Telemetry::Entry::Allocate(size_t count, size_t current) {
+    Add(allocate, count);
+    used.store(current, std::memory_order_relaxed);
+    Max(peakUsed, current);
+}
+
+inline void Telemetry::Entry::Deallocate(size_t count, size_t current) {
+    Add(deallocate, count);
+    used.store(current, std::memory_order_relaxed);
+}
+
+inline void Telemetry::Entry::Fail() {
+    Add(fail, 1);
+}
+
+inline void Telemetry::Entry::Expand(size_t chunks, size_t bytes) {
+    Add(expand, 1);
+    Resize(chunks, bytes);
+}
+
+inline void Telemetry::Entry::Reduce(size_t chunks, size_t bytes) {
+    Add(reduce, 1);
+    Resize(chunks, bytes);
+}
+
+inline void Telemetry::Entry::Resize(size_t chunks, size_t bytes) {
+    total.store(chunks, std::memory_order_relaxed);
+    committed.store(bytes, std::memory_order_relaxed);
+    Max(peakByte, bytes);
+}
+
+inline auto Telemetry::Entry::Read() const -> Record {
+    Record record;
+
+    record.name       = Demangle(geometry.name);
+    record.chunkSize  = geometry.chunkSize;
+    record.chunkCount = geometry.chunkCount;
+    record.alignment  = geometry.alignment;
+    record.blockSize  = geometry.blockSize;
+
+    record.allocate   = allocate.load(std::memory_order_relaxed);
+    record.deallocate = deallocate.load(std::memory_order_relaxed);
+    record.fail       = fail.load(std::memory_order_relaxed);
+    record.expand     = expand.load(std::memory_order_relaxed);
+    record.reduce     = reduce.load(std::memory_order_relaxed);
+
+    record.used      = used.load(std::memory_order_relaxed);
+    record.total     = total.load(std::memory_order_relaxed);
+    record.committed = committed.load(std::memory_order_relaxed);
+
+    record.peak.used      = peakUsed.load(std::memory_order_relaxed);
+    record.peak.committed = peakByte.load(std::memory_order_relaxed);
+    return record;
+}
+
+inline void Telemetry::Entry::Add(std::atomic<uint64_t>& counter, uint64_t value) {
+    // single writer, no read-modify-write
+    if(!shared) {
+        counter.store(counter.load(std::memory_order_relaxed) + value, std::memory_order_relaxed);
+        return;
+    }
+    counter.fetch_add(value, std::memory_order_relaxed);
+}
+
+inline void Telemetry::Entry::Max(std::atomic<uint64_t>& counter, uint64_t value) {
+    uint64_t old = counter.load(std::memory_order_relaxed);
+    if(!shared) {
+        if(old < value) counter.store(value, std::memory_order_relaxed);
+        return;
+    }
+    while(old < value && !counter.compare_exchange_weak(old, value, std::memory_order_relaxed)) {}
+}
+
+inline std::vector<Telemetry::Record> Telemetry::Snapshot() {
+    Registry& registry = Instance();
+    LockGuard _(registry.mtx);
+
+    std::vector<Record> records;
+
+    for(Entry* entry = registry.head; entry; entry = entry->next) {
+        records.push_back(entry->Read());
+    }
+    return records;
+}
+
+inline std::string Telemetry::Demangle(const char* name) {
+#if defined(__GNUG__)
+    int   status    = 0;
+    char* demangled = abi::__cxa_demangle(name, nullptr, nullptr, &status);
+    if(status == 0 && demangled) {
+        std::string result = demangled;
+        std::free(demangled);
+        return result;
+    }
+#endif
+    return name;
+}
+
+inline auto Telemetry::Instance() -> Registry& {
+    static Registry registry;
+    return registry;
+}
+
+inline void Telemetry::Register(Entry* entry) {
+    Registry& registry = Instance();
+    LockGuard _(registry.mtx);
+
+    entry->prev = nullptr;
+    entry->next = registry.head;
+    if(registry.head) registry.head->prev = entry;
+    registry.head = entry;
+}
+
+inline void Telemetry::Unregister(Entry* entry) {
+    Registry& registry = Instance();
+    LockGuard _(registry.mtx);
+
+    if(entry->prev) entry->prev->next = entry->next;
+    else registry.head = entry->next;
+
+    if(entry->next) entry->next->prev = entry->prev;
+}
+
+#endif
@@ -0,0 +1,116 @@
+#ifndef LWE_UTILITIES_TRACE_HPP
+#define LWE_UTILITIES_TRACE_HPP
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <vector>
+
+#include "lock.hpp"
+#include "macro.h"
+
+/*
+    allocation trace
+    - compile with LWE_TRACE, otherwise Write is empty and nothing is recorded
+    - Allocator: allocate / deallocate per chunk, batches as single records
+    - Pool: insert / erase per ID
+    - records go to a buffer of the calling thread, written to the file when full
+    - Stop writes every thread buffer and closes the file
+
+    record, 24 byte
+    - time   : ns since Start
+    - chunk  : address of the chunk, or ID value for insert / erase
+    - size   : CHUNK_SIZE of the allocator, sizeof(T) of the pool
+    - thread : recording thread, 0, 1, 2 ... in order of first record
+    - op     : Op
+
+    file
+    - Header, then records in write order, not sorted by time
+    - native byte order
+
+    use
+
+    Trace::Start("packet.trace");
+    // run workload
+    Trace::Stop();
+
+    for(const Trace::Record& record : Trace::Load("packet.trace")) {
+        // record.op == Trace::ALLOCATE ...
+    }
+
+    replay tool: bench/replay.cpp
+*/
+class Trace {
+public:
+    NO_INSTANTIABLE(Trace);
+
+public:
+    enum Op : uint8_t {
+        ALLOCATE,
+        DEALLOCATE,
+        INSERT,
+        ERASE,
+    };
+
+    struct Record {
+        uint64_t time;
+        uint64_t chunk;
+        uint32_t size;
+        uint16_t thread;
+        uint8_t  op;
+        uint8_t  reserved;
+    };
+
+    struct Header {
+        char     magic[8];
+        uint32_t version;
+        uint32_t record; // sizeof(Record)
+    };
+
+    static constexpr size_t   BUFFER  = 4096; // records per thread
+    static constexpr uint32_t VERSION = 1;
+
+public:
+    static bool Start(const char* path); // false: running or not opened
+    static void Stop();
+    static bool Running();
+
+public:
+    static void Write(Op, uint64_t chunk, size_t size); // when running
+
+public:
+    static std::vector<Record> Load(const char* path); // sorted by time, throw on bad file
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    struct Local {
+        NO_COPYABLE(Local);
+        Local();
+        ~Local();
+
+        TTASLock            mtx;
+        std::vector<Record> records;
+        uint16_t            thread;
+
+        Local* next = nullptr;
+        Local* prev = nullptr;
+    };
+
+    struct Recorder {
+        TTASLock              mtx;
+        FILE*                 file = nullptr;
+        Local*                head = nullptr;
+        Clock::time_point     start;
+        std::atomic_bool      running = false;
+        std::atomic<uint16_t> threads = 0;
+    };
+
+    static Recorder& Instance(); // constructed before any Local, outlives them
+    static Local&    Current();  // buffer of this thread
+    static void      Flush(Recorder&, const std::vector<Record>&); // recorder locked
+};
+
+#include "trace.ipp"
+#endif
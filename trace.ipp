@@ -0,0 +1,163 @@
+#include "trace.hpp"
+
+#ifdef LWE_UTILITIES_TRACE_HPP
+
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+
+inline Trace::Local::Local() {
+    Recorder& recorder = Instance();
+    records.reserve(BUFFER);
+    thread = recorder.threads.fetch_add(1, std::memory_order_relaxed);
+
+    LockGuard _(recorder.mtx);
+    next = recorder.head;
+    if(recorder.head) recorder.head->prev = this;
+    recorder.head = this;
+}
+
+inline Trace::Local::~Local() {
+    Recorder& recorder = Instance();
+    LockGuard _(recorder.mtx);
+
+    {
+        LockGuard __(mtx);
+        Flush(recorder, records);
+        records.clear();
+    }
+
+    if(prev) prev->next = next;
+    else recorder.head = next;
+
+    if(next) next->prev = prev;
+}
+
+inline bool Trace::Start(const char* path) {
+    Recorder& recorder = Instance();
+    LockGuard _(recorder.mtx);
+
+    if(recorder.file) {
+        return false;
+    }
+
+    recorder.file = std::fopen(path, "wb");
+    if(!recorder.file) {
+        return false;
+    }
+
+    Header header = { { 'L', 'W', 'E', 'T', 'R', 'A', 'C', 'E' }, VERSION, sizeof(Record) };
+    std::fwrite(&header, sizeof(Header), 1, recorder.file);
+
+    // written after the last Stop
+    for(Local* local = recorder.head; local; local = local->next) {
+        LockGuard __(local->mtx);
+        local->records.clear();
+    }
+
+    recorder.start = Clock::now();
+    recorder.running.store(true, std::memory_order_release);
+    return true;
+}
+
+inline void Trace::Stop() {
+    Recorder& recorder = Instance();
+    LockGuard _(recorder.mtx);
+
+    if(!recorder.file) {
+        return;
+    }
+    recorder.running.store(false, std::memory_order_release);
+
+    for(Local* local = recorder.head; local; local = local->next) {
+        LockGuard __(local->mtx);
+        Flush(recorder, local->records);
+        local->records.clear();
+    }
+
+    std::fclose(recorder.file);
+    recorder.file = nullptr;
+}
+
+inline bool Trace::Running() {
+    return Instance().running.load(std::memory_order_acquire);
+}
+
+inline void Trace::Write([[maybe_unused]] Op op, [[maybe_unused]] uint64_t chunk, [[maybe_unused]] size_t size) {
+#ifdef LWE_TRACE
+    Recorder& recorder = Instance();
+    if(chunk == 0 || !recorder.running.load(std::memory_order_acquire)) {
+        return;
+    }
+
+    Local& local = Current();
+
+    Record record;
+    record.time     = std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - recorder.start).count();
+    record.chunk    = chunk;
+    record.size     = uint32_t(size);
+    record.thread   = local.thread;
+    record.op       = op;
+    record.reserved = 0;
+
+    std::vector<Record> full;
+    {
+        LockGuard _(local.mtx);
+        local.records.push_back(record);
+        if(local.records.size() < BUFFER) {
+            return;
+        }
+
+        // swap out, file is written without the thread lock
+        full.reserve(BUFFER);
+        full.swap(local.records);
+    }
+
+    LockGuard _(recorder.mtx);
+    Flush(recorder, full);
+#endif
+}
+
+inline std::vector<Trace::Record> Trace::Load(const char* path) {
+    FILE* file = std::fopen(path, "rb");
+    if(!file) {
+        throw std::runtime_error("Trace not found.");
+    }
+
+    Header header;
+    if(std::fread(&header, sizeof(Header), 1, file) != 1 || std::memcmp(header.magic, "LWETRACE", 8) ||
+        header.version != VERSION || header.record != sizeof(Record)) {
+        std::fclose(file);
+        throw std::runtime_error("Invalid trace.");
+    }
+
+    std::vector<Record> records;
+    std::vector<Record> buffer(BUFFER);
+
+    size_t read;
+    while((read = std::fread(buffer.data(), sizeof(Record), BUFFER, file)) > 0) {
+        records.insert(records.end(), buffer.begin(), buffer.begin() + read);
+    }
+    std::fclose(file);
+
+    std::stable_sort(records.begin(), records.end(), [](const Record& lhs, const Record& rhs) { return lhs.time < rhs.time; });
+    return records;
+}
+
+inline auto Trace::Instance() -> Recorder& {
+    static Recorder recorder;
+    return recorder;
+}
+
+inline auto Trace::Current() -> Local& {
+    static thread_local Local local;
+    return local;
+}
+
+inline void Trace::Flush(Recorder& recorder, const std::vector<Record>& records) {
+    if(recorder.file && !records.empty()) {
+        std::fwrite(records.data(), sizeof(Record), records.size(), recorder.file);
+    }
+}
+
+#endif
@@ -1,7 +1,9 @@
 #ifndef LWE_UTILITIES_TYPE_H
 #define LWE_UTILITIES_TYPE_H
 
+#include <cstddef>
 #include <cstdint>
+#include <type_traits>
 
 template<size_t SIZE> struct Block {
     uint8_t data[SIZE];
@@ -19,16 +21,16 @@ public:
     static constexpr size_t PADDING = (N - (sizeof(T) % N)) % N;
 
 private:
-    template<size_t N, class T, bool = std::is_class_v<T>> struct Aligned: public T {
-        int8_t padding[N];
+    template<size_t P, class U, bool = std::is_class_v<U>> struct Aligned: public U {
+        int8_t padding[P];
     };
-    template<class T> struct Aligned<0, T, true>: public T {};
-    template<size_t N, class T> struct Aligned<N, T, false> {
-        T      data;
-        int8_t padding[N];
+    template<class U> struct Aligned<0, U, true>: public U {};
+    template<size_t P, class U> struct Aligned<P, U, false> {
+        U      data;
+        int8_t padding[P];
     };
-    template<class T> struct Aligned<0, T, false> {
-        T data;
+    template<class U> struct Aligned<0, U, false> {
+        U data;
     };
 
 public:
@@ -40,14 +42,18 @@ public:
  */
 template<size_t N> class Aligner<N, void> {
 private:
-    static constexpr size_t X = N - 1;
+    static constexpr size_t X  = N - 1;
+    static constexpr size_t X1 = X | (X >> 1);
+    static constexpr size_t X2 = X1 | (X1 >> 2);
+    static constexpr size_t X4 = X2 | (X2 >> 4);
+    static constexpr size_t X8 = X4 | (X4 >> 8);
+    static constexpr size_t XG = X8 | (X8 >> 16);
 
 public:
-    static constexpr size_t POWER_OF_TWO =
-        N == 0 ? 1 : (X | (X >> 1) | (X >> 2) | (X >> 4) | (X >> 8) | (X >> 16) | (X >> 32)) + 1;
+    static constexpr size_t POWER_OF_TWO = N == 0 ? 1 : (XG | (XG >> 32)) + 1;
 
 public:
-    static constexpr size_t ALIGN_TO_POINTER = sizeof(void*) * (N + sizeof(void*) - 1) / sizeof(void*);
+    static constexpr size_t ALIGN_TO_POINTER = sizeof(void*) * ((N + sizeof(void*) - 1) / sizeof(void*));
 };
 
 #endif
\ No newline at end of file